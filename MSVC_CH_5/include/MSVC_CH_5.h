@@ -1,6 +1,14 @@
 #pragma once
 #include "helper.h"
 #include "MultiPoly.h"
+#include "EvalKey.h"
+#include "PreparedPoly.h"
+#include "QuadraticPoly.h"
+#include "LinearForms.h"
+#include "Circuit.h"
+#include "Serialize.h"
+#include "StreamedPoly.h"
+#include "PrecomputePool.h"
 
 namespace CH5 {
 struct Env {
@@ -12,20 +20,86 @@ struct Env {
     int k;
     int d;
     int m;
+    int n; // servers that receive shares; KeyGen raises it to at least k
 };
 
 using PK_F = ZZ;
 using VK_F = ZZ; 
-using EK_F = Vec<MultiPoly<Fq>>;
+using EK_F = EvalKey<MultiPoly<Fq>>;
+using PEK_F = EvalKey<PreparedPoly<Fq>>; // preprocessed server key
+using QEK_F = EvalKey<QuadraticPoly<Fq>>; // dense server key for d <= 2
+using EK_FV = EvalKey<Vec<MultiPoly<Fq>>>; // one key for all outputs of a vector-valued F
+using LEK_F = EvalKey<LinearForms<Fq>>; // dense key for r linear forms, d = 1
+using CEK_F = EvalKey<Circuit<Fq>>; // circuit key; server cost tracks the gate count
 using VK_X = ZZ;
 
+// Input-independent part of one ProbGen: the shares with X = 0, including
+// the b shares and the zero-sharing masks, and g^alpha
+struct PRE_X {
+    Mat<Fq> sigma;
+    VK_X vk;
+};
+
 void Initialize(Env &env, int t, int secpar = 256);
 
 void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F);
 
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+
+// Dense quadratic key for d <= 2. The MultiPoly form is converted once; the
+// QuadraticPoly form never builds MultiPoly terms but still stores all
+// (m+1)(m+2)/2 coefficients, see QuadraticPoly.h.
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const QuadraticPoly<Fq> &F);
+
+// F as an arithmetic circuit; d is its declared degree bound
+void KeyGen(PK_F &pk, VK_F &vk, CEK_F &ek, Env &env, const Circuit<Fq> &F);
+
+// Vector-valued F = (F_1, ..., F_r) over the same variables; d is the
+// largest degree among the outputs
+void KeyGen(PK_F &pk, VK_F &vk, EK_FV &ek, Env &env, const Vec<MultiPoly<Fq>> &F);
+void KeyGen(PK_F &pk, VK_F &vk, LEK_F &ek, Env &env, const LinearForms<Fq> &F);
+
 void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PK_F &pk, const Vec<Fq> &X);
 
-void Compute(Vec<Fq> & pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &sigma_i, const Env &env);
+// Shares and verification keys for many inputs at once. The Vandermonde
+// table over the share points and the g-exponentiation table are built once
+// and reused for every input.
+void ProbGenBatch(Vec<VK_X> &vk, Vec<Mat<Fq>> &sigma, const Env& env, const PK_F &pk, const Vec<Vec<Fq>> &Xs);
+
+// Offline/online ProbGen. ProbGenOffline does all sampling, sharing and the
+// exponentiation; ProbGenOnline adds X_j to every share of c_j, O(k*m).
+// Every PRE_X must be consumed by exactly one ProbGenOnline call.
+void ProbGenOffline(PRE_X &pre, const Env& env, const PK_F &pk);
+void ProbGenOnline(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PRE_X &pre, const Vec<Fq> &X);
+
+template <typename Poly>
+void Compute(Vec<Fq> & pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Env &env);
 
 bool Verify(Fq &res, const VK_F &vk_f, const VK_X & vk_x, Mat<Fq> pi, const Env &env);
+
+// Straggler-tolerant Verify. With env.n > k servers holding shares, any k
+// responses suffice: pi[r] is the response of server idx[r], and the first
+// k rows are used.
+bool VerifyAt(Fq &res, const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+// Error-correcting Verify for more than k responses. The responses are
+// decoded as Reed-Solomon codewords (phi of degree dt, psi of degree k-1),
+// which corrects up to (|idx| - k) / 2 wrong rows without a rerun. bad lists
+// the servers whose rows were corrected.
+bool VerifyRobust(Fq &res, Vec<long> &bad, const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+// Vector-valued F. ProbGenMulti shares X and b once for all r outputs but
+// gives every output its own zero-sharings a_j and e_j (sigma is
+// n x (m + 1 + 2r)), so phi_j - phi_j' stays masked. pi_i holds
+// (phi_j, psi_j) for every output side by side, and VerifyMulti folds the
+// r checks with random weights into a single one.
+// Polys is Vec<MultiPoly<Fq>> (EK_FV) or LinearForms<Fq> (LEK_F)
+void ProbGenMulti(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PK_F &pk, const Vec<Fq> &X, long r);
+template <typename Polys>
+void ComputeMulti(Vec<Fq> &pi_i, int idx, const Polys &ek_i, const Vec<Fq> &sigma_i, const Env &env);
+bool VerifyMulti(Vec<Fq> &res, const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Env &env);
+
+// Verify N instances with one small-exponent batch test; ok[n] flags each instance
+bool VerifyBatch(Vec<Fq> &res, std::vector<bool> &ok, const VK_F &vk_f, const Vec<VK_X> &vk_x, const Vec<Mat<Fq>> &pi, const Env &env);
 }
\ No newline at end of file
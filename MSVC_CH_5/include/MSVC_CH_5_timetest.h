@@ -1,5 +1,6 @@
 #pragma once
 #include "MSVC_CH_5.h"
+#include "Workload.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -7,8 +8,8 @@
 
 namespace CH5 {
 
-TestResultData MSVC_CH_5_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false);
+TestResultData MSVC_CH_5_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false, const WorkloadSpec &workload = WorkloadSpec());
 // Simple timer class
-SimpleTimingResult runSingleTest(int d, int m, int t, int secpar);
+SimpleTimingResult runSingleTest(int d, int m, int t, int secpar, const WorkloadSpec &workload = WorkloadSpec());
 
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ void Initialize(Env &env, int t, int secpar)
 {
     env.secpar = secpar;
     env.t = t;
+    env.n = 0;
         //GenGermainPrime(env.ord, env.secpar);
     conv<ZZ>(env.ord, "241231170316424564953358597862841670333");
     env.fq = 2 * env.ord + 1;
@@ -13,26 +14,75 @@ void Initialize(Env &env, int t, int secpar)
     env.g = FindGen(env.ord, env.fq, 10000);
 }
 
-void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F)
+// Everything KeyGen produces except the server evaluation key
+static void KeyGenPublic(PK_F &pk, VK_F &vk, Env &env, long m, int d)
 {
-    if (F.varCount() == 0 || F.maxDegree() < 0)
-        throw std::invalid_argument("Invalid polynomial F");
-
-    env.m = F.varCount();
-    env.d = F.maxDegree();
+    env.m = m;
+    env.d = d;
     env.k = (env.d + 1) * env.t + 1;
+    if (env.n < env.k)
+        env.n = env.k;
 
     pk = 0;
     vk = 0;
+}
 
-    ek.SetLength(env.k);
-    for (int i = 0; i < env.k; ++i)
-    {
-        ek[i] = F;
-    }
+template <typename Poly>
+static void KeyGenPublic(PK_F &pk, VK_F &vk, Env &env, const Poly &F)
+{
+    if (F.varCount() == 0 || F.maxDegree() < 0)
+        throw std::invalid_argument("Invalid polynomial F");
+
+    KeyGenPublic(pk, vk, env, F.varCount(), F.maxDegree());
 }
 
-void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec<Fq> &X)
+void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F);
+    ek = EK_F::share(F, env.n);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F);
+    ek = PEK_F::share(PreparedPoly<Fq>(F), env.n);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    KeyGen(pk, vk, ek, env, QuadraticPoly<Fq>(F));
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const QuadraticPoly<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F);
+    ek = QEK_F::share(F, env.n);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, CEK_F &ek, Env &env, const Circuit<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F);
+    ek = CEK_F::share(F, env.n);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, EK_FV &ek, Env &env, const Vec<MultiPoly<Fq>> &F)
+{
+    long m;
+    int d;
+    SystemShape(m, d, F);
+    KeyGenPublic(pk, vk, env, m, d);
+    ek = EK_FV::share(F, env.n);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, LEK_F &ek, Env &env, const LinearForms<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F.varCount(), 1);
+    ek = LEK_F::share(F, env.n);
+}
+
+// Shares of X and b, then an independent zero-sharing pair (a_j, e_j) for
+// each of r outputs: sigma is n x (m + 1 + 2r)
+static void ShareInput(VK_X &vk, Mat<Fq> &sigma, const Env &env, const Vec<Fq> &X, long r)
 {
     if (X.length() != env.m)
         throw std::invalid_argument("Length of X must match number of variables in pk");
@@ -56,17 +106,22 @@ void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec
     ZZ_pX b;
     random(b, env.t + 1);
     SetCoeff(b, 0, alpha);
-    sigma.SetDims(env.k, env.m + 3);
+    sigma.SetDims(env.n, env.m + 1 + 2 * r);
 
-        // Context hiding, generating 0's shares
-    ZZ_pX a_poly, e_poly;
-    random(a_poly, env.k);
-    random(e_poly, env.k);
-    SetCoeff(a_poly, 0, 0); // Set constant term to 0
-    SetCoeff(e_poly, 0, 0); // Set constant term to 0
+        // Context hiding, generating 0's shares: a has the degree of F(c), e that of psi
+    Vec<ZZ_pX> a_poly, e_poly;
+    a_poly.SetLength(r);
+    e_poly.SetLength(r);
+    for (long j = 0; j < r; ++j)
+    {
+        random(a_poly[j], env.d * env.t + 1);
+        random(e_poly[j], env.k);
+        SetCoeff(a_poly[j], 0, 0); // Set constant term to 0
+        SetCoeff(e_poly[j], 0, 0); // Set constant term to 0
+    }
 
     ZZ_p tmp;
-    for (int i = 0; i < env.k; ++i)
+    for (int i = 0; i < env.n; ++i)
     {
         tmp = to_ZZ_p(i);
         for (int j = 0; j < env.m; ++j)
@@ -74,16 +129,171 @@ void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec
             eval(sigma[i][j], c[j], tmp);
         }
         eval(sigma[i][env.m], b, tmp);
-        eval(sigma[i][env.m + 1], a_poly, tmp);
-        eval(sigma[i][env.m + 2], e_poly, tmp);
+        for (long j = 0; j < r; ++j)
+        {
+            eval(sigma[i][env.m + 1 + 2 * j], a_poly[j], tmp);
+            eval(sigma[i][env.m + 2 + 2 * j], e_poly[j], tmp);
+        }
     }
 
     PowerMod(vk, env.g, rep(alpha), env.fq);
 }
 
-void Compute(Vec<Fq> &pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &sigma_i, const Env &env)
+void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec<Fq> &X)
+{
+    ShareInput(vk, sigma, env, X, 1);
+}
+
+void ProbGenMulti(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec<Fq> &X, long r)
+{
+    if (r < 1)
+        throw std::invalid_argument("ProbGenMulti needs at least one output");
+    ShareInput(vk, sigma, env, X, r);
+}
+
+void ProbGenBatch(Vec<VK_X> &vk, Vec<Mat<Fq>> &sigma, const Env &env, const PK_F &pk, const Vec<Vec<Fq>> &Xs)
+{
+    long N = Xs.length();
+    for (long n = 0; n < N; ++n)
+    {
+        if (Xs[n].length() != env.m)
+            throw std::invalid_argument("Length of X must match number of variables in pk");
+    }
+
+    // Sample alpha for every input
+    Vec<Fq> alpha;
+    alpha.SetLength(N);
+    for (long n = 0; n < N; ++n)
+    {
+        do
+        {
+            alpha[n] = random_ZZ_p(); // Ensure alpha is non-zero
+        } while (alpha[n] == 0);
+    }
+
+    // Coefficients of every c_j and b side by side, input n in columns n*(m+1)..
+    // Row 0 holds X and alpha, rows 1..t are random. All shares are then V * C.
+    long cols = env.m + 1;
+    Mat<Fq> C = random_mat_ZZ_p(env.t + 1, N * cols);
+    for (long n = 0; n < N; ++n)
+    {
+        for (int j = 0; j < env.m; ++j)
+        {
+            C[0][n * cols + j] = Xs[n][j];
+        }
+        C[0][n * cols + env.m] = alpha[n];
+    }
+    Mat<Fq> V, S;
+    Vandermonde(V, env.n, env.t + 1);
+    mul(S, V, C);
+
+    // Context hiding, generating 0's shares: per input a mask a of degree dt
+    // and a mask e of degree k-1
+    Mat<Fq> A = random_mat_ZZ_p(env.k, 2 * N);
+    for (long n = 0; n < 2 * N; ++n)
+    {
+        A[0][n] = 0; // Set constant term to 0
+    }
+    for (long r = env.d * env.t + 1; r < env.k; ++r)
+    {
+        for (long n = 0; n < N; ++n)
+        {
+            A[r][2 * n] = 0;
+        }
+    }
+    Mat<Fq> W, Z;
+    Vandermonde(W, env.n, env.k);
+    mul(Z, W, A);
+
+    long bits = NumBits(env.ord);
+    FixedBaseExp gexp(env.g, env.fq, bits, FixedBaseExp::bestWindow(bits, N));
+
+    vk.SetLength(N);
+    sigma.SetLength(N);
+    for (long n = 0; n < N; ++n)
+    {
+        sigma[n].SetDims(env.n, env.m + 3);
+        for (int i = 0; i < env.n; ++i)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                sigma[n][i][j] = S[i][n * cols + j];
+            }
+            sigma[n][i][env.m + 1] = Z[i][2 * n];
+            sigma[n][i][env.m + 2] = Z[i][2 * n + 1];
+        }
+        gexp.power(vk[n], rep(alpha[n]));
+    }
+}
+
+void ProbGenOffline(PRE_X &pre, const Env &env, const PK_F &pk)
+{
+    Fq alpha;
+    do
+    {
+        alpha = random_ZZ_p(); // Ensure alpha is non-zero
+    } while (alpha == 0);
+
+    // Coefficients of every c_j with X = 0, and of b; rows 1..t are random
+    long cols = env.m + 1;
+    Mat<Fq> C = random_mat_ZZ_p(env.t + 1, cols);
+    for (int j = 0; j < env.m; ++j)
+    {
+        C[0][j] = 0;
+    }
+    C[0][env.m] = alpha;
+    Mat<Fq> V, S;
+    Vandermonde(V, env.n, env.t + 1);
+    mul(S, V, C);
+
+    // Context hiding, generating 0's shares: a of degree dt, e of degree k-1
+    Mat<Fq> A = random_mat_ZZ_p(env.k, 2);
+    A[0][0] = 0;
+    A[0][1] = 0;
+    for (long r = env.d * env.t + 1; r < env.k; ++r)
+    {
+        A[r][0] = 0;
+    }
+    Mat<Fq> W, Z;
+    Vandermonde(W, env.n, env.k);
+    mul(Z, W, A);
+
+    pre.sigma.SetDims(env.n, env.m + 3);
+    for (int i = 0; i < env.n; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            pre.sigma[i][j] = S[i][j];
+        }
+        pre.sigma[i][env.m + 1] = Z[i][0];
+        pre.sigma[i][env.m + 2] = Z[i][1];
+    }
+    PowerMod(pre.vk, env.g, rep(alpha), env.fq);
+}
+
+void ProbGenOnline(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PRE_X &pre, const Vec<Fq> &X)
+{
+    if (X.length() != env.m)
+        throw std::invalid_argument("Length of X must match number of variables in pk");
+    if (pre.sigma.NumRows() != env.n || pre.sigma.NumCols() != env.m + 3)
+        throw std::invalid_argument("Precomputation does not match env");
+
+    // X_j is the constant term of c_j, so it adds to every share of c_j
+    sigma = pre.sigma;
+    for (int i = 0; i < env.n; ++i)
+    {
+        for (int j = 0; j < env.m; ++j)
+        {
+            sigma[i][j] += X[j];
+        }
+    }
+    vk = pre.vk;
+}
+
+template <typename Poly>
+void Compute(Vec<Fq> &pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Env &env)
 {
-    if (idx < 0 || idx >= env.k)
+    if (idx < 0 || idx >= env.n)
         throw std::out_of_range("Index out of range in Compute");
 
     if (ek_i.varCount() != sigma_i.length() - 3)
@@ -102,6 +312,45 @@ void Compute(Vec<Fq> &pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &s
     pi_i[1] = pi_i[0] * sigma_i[env.m] + sigma_i[env.m + 2];
 }
 
+template void Compute(Vec<Fq> &, int, const MultiPoly<Fq> &, const Vec<Fq> &, const Env &);
+template void Compute(Vec<Fq> &, int, const PreparedPoly<Fq> &, const Vec<Fq> &, const Env &);
+template void Compute(Vec<Fq> &, int, const QuadraticPoly<Fq> &, const Vec<Fq> &, const Env &);
+template void Compute(Vec<Fq> &, int, const Circuit<Fq> &, const Vec<Fq> &, const Env &);
+template void Compute(Vec<Fq> &, int, const MappedPoly &, const Vec<Fq> &, const Env &);
+template void Compute(Vec<Fq> &, int, const StreamedPoly &, const Vec<Fq> &, const Env &);
+
+template <typename Polys>
+void ComputeMulti(Vec<Fq> &pi_i, int idx, const Polys &ek_i, const Vec<Fq> &sigma_i, const Env &env)
+{
+    if (idx < 0 || idx >= env.n)
+        throw std::out_of_range("Index out of range in Compute");
+
+    // The input and b shares serve every output; each output has its own a_j and e_j
+    long r = (sigma_i.length() - env.m - 1) / 2;
+    if (r < 1 || sigma_i.length() != env.m + 1 + 2 * r)
+        throw std::invalid_argument("Length of sigma_i must be m + 1 + 2r, see ProbGenMulti");
+
+    vector<Fq> eval_points(env.m);
+    for (int i = 0; i < env.m; ++i)
+    {
+        eval_points[i] = sigma_i[i];
+    }
+
+    vector<Fq> vals;
+    EvaluateAll(vals, ek_i, eval_points);
+    if (static_cast<long>(vals.size()) != r)
+        throw std::invalid_argument("sigma_i must carry one mask pair per output of ek_i");
+    pi_i.SetLength(2 * r);
+    for (long j = 0; j < r; ++j)
+    {
+        pi_i[2 * j] = vals[j] + sigma_i[env.m + 1 + 2 * j];
+        pi_i[2 * j + 1] = pi_i[2 * j] * sigma_i[env.m] + sigma_i[env.m + 2 + 2 * j];
+    }
+}
+
+template void ComputeMulti(Vec<Fq> &, int, const Vec<MultiPoly<Fq>> &, const Vec<Fq> &, const Env &);
+template void ComputeMulti(Vec<Fq> &, int, const LinearForms<Fq> &, const Vec<Fq> &, const Env &);
+
 bool Verify(Fq &res, const VK_F &vk_f, const VK_X &vk_x, Mat<Fq> pi, const Env &env)
 {
     if (pi.NumRows() != env.k || pi.NumCols() != 2)
@@ -131,4 +380,143 @@ bool Verify(Fq &res, const VK_F &vk_f, const VK_X &vk_x, Mat<Fq> pi, const Env &
     //cout << "Verification successful." << endl;
     return true;
 }
+
+bool VerifyAt(Fq &res, const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env)
+{
+    if (pi.NumRows() != idx.length() || pi.NumCols() != 2)
+        throw std::invalid_argument("pi needs one row per responder");
+
+    // phi(0) and psi(0) from the first k responders
+    Vec<Fq> pts, w;
+    ResponderPoints(pts, idx, env.k, env.n);
+    LagrangeWeights(w, pts, ZZ_p());
+    Fq phi0, psi0;
+    for (int r = 0; r < env.k; ++r)
+    {
+        phi0 += w[r] * pi[r][0];
+        psi0 += w[r] * pi[r][1];
+    }
+
+    if (PowerMod(env.g, rep(psi0), env.fq) != PowerMod(vk_x, rep(phi0), env.fq))
+    {
+        std::cerr << "Verification failed: vk_x.a does not match vk_x.alpha" << std::endl;
+        return false;
+    }
+    res = phi0;
+    return true;
+}
+
+bool VerifyRobust(Fq &res, Vec<long> &bad, const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env)
+{
+    if (pi.NumRows() != idx.length() || pi.NumCols() != 2)
+        throw std::invalid_argument("pi needs one row per responder");
+    if (idx.length() < env.k)
+        throw std::invalid_argument("Fewer responses than the k the protocol needs");
+
+    // phi has degree dt and psi degree (d+1)t = k-1
+    Vec<long> dims;
+    dims.SetLength(2);
+    dims[0] = env.k - env.t;
+    dims[1] = env.k;
+    Vec<Fq> at0;
+    if (!DecodeResponses(at0, bad, pi, idx, dims, env.n))
+    {
+        std::cerr << "Verification failed: too many faulty responses to decode" << std::endl;
+        return false;
+    }
+
+    if (PowerMod(env.g, rep(at0[1]), env.fq) != PowerMod(vk_x, rep(at0[0]), env.fq))
+    {
+        std::cerr << "Verification failed: vk_x.a does not match vk_x.alpha" << std::endl;
+        return false;
+    }
+    res = at0[0];
+    return true;
+}
+
+bool VerifyMulti(Vec<Fq> &res, const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Env &env)
+{
+    long r = pi.NumCols() / 2;
+    if (pi.NumRows() != env.k || r == 0 || pi.NumCols() != 2 * r)
+        throw std::invalid_argument("pi must have k rows and two columns per output");
+
+    // phi_j(0) and psi_j(0) for every output, folded with random weights so
+    // that one psi(0) == b * phi(0) check in the exponent covers all r. The
+    // per-output masks a_j, e_j of ProbGenMulti vanish at 0.
+    Vec<Fq> w;
+    res.SetLength(r);
+    ShareWeights(w, env.k, ZZ_p());
+    Fq phi0, psi0, phi_j, psi_j, rho;
+    for (long j = 0; j < r; ++j)
+    {
+        clear(phi_j);
+        clear(psi_j);
+        for (int i = 0; i < env.k; ++i)
+        {
+            phi_j += w[i] * pi[i][2 * j];
+            psi_j += w[i] * pi[i][2 * j + 1];
+        }
+        res[j] = phi_j;
+        random(rho);
+        phi0 += rho * phi_j;
+        psi0 += rho * psi_j;
+    }
+
+    if (PowerMod(env.g, rep(psi0), env.fq) != PowerMod(vk_x, rep(phi0), env.fq))
+    {
+        std::cerr << "Verification failed: vk_x.a does not match vk_x.alpha" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VerifyBatch(Vec<Fq> &res, std::vector<bool> &ok, const VK_F &vk_f, const Vec<VK_X> &vk_x, const Vec<Mat<Fq>> &pi, const Env &env)
+{
+    long N = pi.length();
+    if (vk_x.length() != N)
+        throw std::invalid_argument("VerifyBatch needs one vk_x per instance");
+    for (long n = 0; n < N; ++n)
+    {
+        if (pi[n].NumRows() != env.k || pi[n].NumCols() != 2)
+            throw std::invalid_argument("Length of pi must match k in Env");
+    }
+
+    // phi(0) and psi(0) are the same linear combination of the k shares for every instance
+    Vec<Fq> w;
+    ShareWeights(w, env.k, ZZ_p());
+
+    Vec<ZZ> u, v;
+    u.SetLength(N);
+    v.SetLength(N);
+    res.SetLength(N);
+    for (long n = 0; n < N; ++n)
+    {
+        Fq phi0, psi0;
+        for (int i = 0; i < env.k; ++i)
+        {
+            phi0 += w[i] * pi[n][i][0];
+            psi0 += w[i] * pi[n][i][1];
+        }
+        u[n] = rep(psi0);
+        v[n] = rep(phi0);
+        res[n] = phi0;
+    }
+
+    // g^{psi(0)} == vk_x^{phi(0)} for all instances at once
+    if (!BatchExpCheck(ok, env.g, vk_x, u, v, env.ord, env.fq))
+    {
+        long bad = 0;
+        for (long n = 0; n < N; ++n)
+        {
+            if (!ok[n])
+            {
+                clear(res[n]);
+                ++bad;
+            }
+        }
+        std::cerr << "Verification failed for " << bad << " of " << N << " instances" << std::endl;
+        return false;
+    }
+    return true;
+}
 }
\ No newline at end of file
@@ -1,6 +1,14 @@
 #pragma once
 #include "helper.h"
 #include "MultiPoly.h"
+#include "EvalKey.h"
+#include "PreparedPoly.h"
+#include "QuadraticPoly.h"
+#include "LinearForms.h"
+#include "Circuit.h"
+#include "Serialize.h"
+#include "StreamedPoly.h"
+#include "PrecomputePool.h"
 namespace RH4 {
 
 struct Env {
@@ -12,39 +20,194 @@ struct Env {
     int k;
     int d;
     int m;
+    int n; // servers that receive shares; KeyGen raises it to at least k
 };
 
-using PK_F = Vec<MultiPoly<Fq>>;
+// f = F(ell_1(u), ..., ell_m(u)) is univariate, so it is kept as a ZZ_pX.
+// The client needs f too, to fix the verification target at ProbGen time.
+struct PK_F {
+    PackedAffine ell;
+    ZZ_pX f;
+};
 struct VK_F {
-    Vec<MultiPoly<Fq>> ell;
-    MultiPoly<Fq> f;
+    PackedAffine ell;
+    ZZ_pX f;
 };
-using EK_F = Vec<MultiPoly<Fq>>;
+using EK_F = EvalKey<MultiPoly<Fq>>;
+using PEK_F = EvalKey<PreparedPoly<Fq>>; // preprocessed server key
+using QEK_F = EvalKey<QuadraticPoly<Fq>>; // dense server key for d <= 2
+using EK_FV = EvalKey<Vec<MultiPoly<Fq>>>; // one key for all outputs of a vector-valued F
+using LEK_F = EvalKey<LinearForms<Fq>>; // dense key for r linear forms, d = 1
+using CEK_F = EvalKey<Circuit<Fq>>; // circuit key; server cost tracks the gate count
 struct VK_X {
-    Vec<ZZ> a;
+    ZZ gfa; // g^{f(a)}, the side of Verify that does not depend on pi
     Vec<ZZ> alpha; 
     //Fq a_bk;
     //Fq alpha_bk;
 };
 
+// Keys for a vector-valued F = (F_1, ..., F_r): one ell, f_j = F_j(ell(u))
+struct PK_FV {
+    PackedAffine ell;
+    Vec<ZZ_pX> f;
+};
+struct VK_FV {
+    PackedAffine ell;
+    Vec<ZZ_pX> f;
+};
+
+// VK_X for all r outputs of one input: g^{f_j(a)} per output, one set of alpha powers
+struct VK_XV {
+    Vec<ZZ> gfa;
+    Vec<ZZ> alpha;
+};
+
 struct VK_theta {
     VK_X vkx;
-    ZZ gbeta;
+    ZZ target; // g^{f(a) + z(alpha)}
     //Fq beta;
 };
 using SK_theta = Fq;
 
+// Masks for all r outputs; target_j = g^{f_j(a) + z_j(alpha)}
+struct VK_thetaV {
+    VK_XV vkx;
+    Vec<ZZ> target;
+};
+
+// Designated-verifier keys, kept by the client: the trapdoors behind one
+// VK_X and the mask value z(alpha) that VK_theta::target hides in the exponent
+struct SK_X {
+    Fq a;
+    Fq alpha;
+};
+
+struct DVK_theta {
+    SK_X skx;
+    Fq z_alpha;
+};
+
+// Input-independent part of one ProbGen: share i of c_j is
+// base[i][j] + X_j * w[i], column m holds the b shares, vk is exponentiated
+struct PRE_X {
+    Fq a;
+    Fq alpha;
+    Mat<Fq> base;
+    Vec<Fq> w;
+    VK_X vk;
+};
+
+// Input-independent part of one MaskGen: beta, the shares of z, the
+// coefficients z_1..z_{k-1} as exponents and g^beta
+struct PRE_theta {
+    Fq beta;
+    Vec<Fq> theta;
+    Vec<ZZ> z;
+    ZZ gbeta;
+};
+
 void Initialize(Env &env, int t, int secpar = 256);
 
 void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F);
 
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+
+// Dense quadratic key for d <= 2. The MultiPoly form is converted once; the
+// QuadraticPoly form never builds MultiPoly terms but still stores all
+// (m+1)(m+2)/2 coefficients, see QuadraticPoly.h.
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const QuadraticPoly<Fq> &F);
+
+// F as an arithmetic circuit; d is its declared degree bound
+void KeyGen(PK_F &pk, VK_F &vk, CEK_F &ek, Env &env, const Circuit<Fq> &F);
+
+// Vector-valued F = (F_1, ..., F_r) over the same variables; d is the
+// largest degree among the outputs
+void KeyGen(PK_FV &pk, VK_FV &vk, EK_FV &ek, Env &env, const Vec<MultiPoly<Fq>> &F);
+void KeyGen(PK_FV &pk, VK_FV &vk, LEK_F &ek, Env &env, const LinearForms<Fq> &F);
+
+// Key refresh for F <- F + delta. Only delta is composed with ell and added
+// to f, and the shared evaluation key is patched in place, so the cost is
+// proportional to the terms of delta rather than of F. delta must be over the
+// same m variables with degree at most d; changing d needs a new KeyGen.
+// The patch follows EvalKey::modify: servers must not be evaluating through
+// ek[i] during the update, and those holding ek.view(i) keep the old F.
+void UpdateKey(PK_F &pk, VK_F &vk, EK_F &ek, const Env &env, const MultiPoly<Fq> &delta);
+
 void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PK_F &pk, Vec<Fq> X);
 
-void Compute(Fq & pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &sigma_i, const Fq& theta_i, const Env &env);
+// Shares only, without the group elements of VK_X; for VerifyPrivate
+void ProbGenPrivate(SK_X &sk, Mat<Fq> &sigma, const Env& env, const PK_F &pk, const Vec<Fq> &X);
+
+// Shares and verification keys for many inputs at once. The Vandermonde
+// table over the share points and the g-exponentiation table are built once
+// and reused for every input.
+void ProbGenBatch(Vec<VK_X> &vk, Vec<Mat<Fq>> &sigma, const Env& env, const PK_F &pk, const Vec<Vec<Fq>> &Xs);
+
+// Offline/online ProbGen. ProbGenOffline samples a, alpha, r and b and does
+// pk(a) and the exponentiations; ProbGenOnline only folds X in, O(k*m).
+// Every PRE_X must be consumed by exactly one ProbGenOnline call.
+void ProbGenOffline(PRE_X &pre, const Env& env, const PK_F &pk);
+void ProbGenOnline(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PRE_X &pre, const Vec<Fq> &X);
+
+template <typename Poly>
+void Compute(Fq & pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Fq& theta_i, const Env &env);
 
 bool Verify(const VK_F &vk_f, const VK_theta & vk_theta, Vec<Fq> pi, const Env &env);
 
+// Straggler-tolerant Verify and Reconstruct. With env.n > k servers holding
+// shares, any k responses suffice: pi[r] is the response of server idx[r],
+// and the first k entries are used.
+bool VerifyAt(const VK_F &vk_f, const VK_theta &vk_theta, const Vec<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+// Error-correcting Verify and Reconstruct for more than k responses. The
+// responses are decoded as a Reed-Solomon codeword (phi of degree k-1),
+// which corrects up to (|idx| - k) / 2 wrong entries without a rerun. bad
+// lists the servers whose responses were corrected, and res is F(X) if the
+// check on the decoded phi passes.
+bool VerifyRobust(Fq &res, Vec<long> &bad, const VK_F &vk_f, const VK_theta &vk_theta, const SK_theta &sk, const Vec<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+// Vector-valued F. One ProbGen shares X once for all r outputs; every output
+// gets its own mask from MaskGenMulti (theta is n x r, sk holds the r betas),
+// each server returns one value per output (pi is k x r), and VerifyMulti
+// folds the r checks with random weights into a single one.
+void ProbGenMulti(VK_XV &vk, Mat<Fq> &sigma, const Env &env, const PK_FV &pk, const Vec<Fq> &X);
+void MaskGenMulti(VK_thetaV &vk, Vec<Fq> &sk, Mat<Fq> &theta, const Env &env, const VK_XV &vk_x);
+// Polys is Vec<MultiPoly<Fq>> (EK_FV) or LinearForms<Fq> (LEK_F)
+template <typename Polys>
+void ComputeMulti(Vec<Fq> &pi_i, int idx, const Polys &ek_i, const Vec<Fq> &sigma_i, const Vec<Fq> &theta_i, const Env &env);
+bool VerifyMulti(const VK_FV &vk_f, const VK_thetaV &vk_theta, const Mat<Fq> &pi, const Env &env);
+void ReconstructMulti(Vec<Fq> &res, const Vec<Fq> &sk, const Mat<Fq> &pi, const Env &env);
+
+// Designated-verifier check phi(alpha) == f(a) + z(alpha), entirely in the field
+bool VerifyPrivate(const VK_F &vk_f, const DVK_theta &vk_theta, const Vec<Fq> &pi, const Env &env);
+
+// Verify N instances under one VK_F with a single folded check; ok[n] flags each instance
+bool VerifyBatch(std::vector<bool> &ok, const VK_F &vk_f, const Vec<VK_theta> &vk_theta, const Vec<Vec<Fq>> &pi, const Env &env);
+
 void MaskGen(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env& env, const VK_X &vk_x);
 
+// Offline/online MaskGen. Only the k-1 exponentiations with the vk_x.alpha
+// bases depend on the request; MaskGenOnline does just those.
+void MaskGenOffline(PRE_theta &pre, const Env& env);
+void MaskGenOnline(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env& env, const PRE_theta &pre, const VK_X &vk_x);
+
+void MaskGenPrivate(DVK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env& env, const SK_X &sk_x);
+
 void Reconstruct(Fq & res, const SK_theta &sk, const Vec<Fq> &pi, const Env &env);
+
+void ReconstructAt(Fq &res, const SK_theta &sk, const Vec<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+void writeBinary(std::ostream &out, const PK_F &pk);
+void readBinary(std::istream &in, PK_F &pk);
+void writeBinary(std::ostream &out, const VK_F &vk);
+void readBinary(std::istream &in, VK_F &vk);
+void writeBinary(std::ostream &out, const VK_X &vk);
+void readBinary(std::istream &in, VK_X &vk);
+void writeBinary(std::ostream &out, const VK_theta &vk);
+void readBinary(std::istream &in, VK_theta &vk);
+void writeBinary(std::ostream &out, const SK_X &sk);
+void readBinary(std::istream &in, SK_X &sk);
+void writeBinary(std::ostream &out, const DVK_theta &vk);
+void readBinary(std::istream &in, DVK_theta &vk);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "MSVC_RH_4.h"
+#include "Workload.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -7,7 +8,7 @@
 namespace RH4 {
 
 // Function to run simple timing tests for MSVC_RH_4
-TestResultData MSVC_RH_4_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false);
+TestResultData MSVC_RH_4_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false, const WorkloadSpec &workload = WorkloadSpec());
 
-SimpleTimingResult runSingleTest(int d, int m, int t, int secpar);
+SimpleTimingResult runSingleTest(int d, int m, int t, int secpar, const WorkloadSpec &workload = WorkloadSpec());
 }
\ No newline at end of file
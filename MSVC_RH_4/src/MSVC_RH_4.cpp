@@ -5,6 +5,7 @@ void Initialize(Env &env, int t, int secpar)
 {
     env.secpar = secpar;
     env.t = t;
+    env.n = 0;
     //GenGermainPrime(env.ord, env.secpar);
     conv<ZZ>(env.ord, "241231170316424564953358597862841670333");
     env.fq = 2 * env.ord + 1;
@@ -12,58 +13,149 @@ void Initialize(Env &env, int t, int secpar)
     env.g = FindGen(env.ord, env.fq, 10000);
 }
 
-void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F)
+// Sizes for m variables of degree d
+static void KeyGenEnv(Env &env, long m, int d)
+{
+    env.m = m;
+    env.d = d;
+    env.k = env.d * (env.t + 1) + 1;
+    if (env.n < env.k)
+        env.n = env.k;
+}
+
+// Everything KeyGen produces except the server evaluation key
+template <typename Poly>
+static void KeyGenPublic(PK_F &pk, VK_F &vk, Env &env, const Poly &F)
 {
     if (F.varCount() == 0 || F.maxDegree() < 0)
         throw std::invalid_argument("Invalid polynomial F");
 
-    pk.kill();
-    vk.ell.kill();
+    KeyGenEnv(env, F.varCount(), F.maxDegree());
+
+    // Random affine ell_i(u) = c_i + s_i * u for every variable
+    pk.ell = PackedAffine::random(F.varCount());
+    pk.f = pk.ell.compose(F);
+
+    vk.ell = pk.ell;
+    vk.f = pk.f;
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
     ek.kill();
+    KeyGenPublic(pk, vk, env, F);
+    ek = EK_F::share(F, env.n);
+}
 
-    env.m = F.varCount();
-    env.d = F.maxDegree();
-    env.k = env.d * (env.t + 1) + 1;
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    ek.kill();
+    KeyGenPublic(pk, vk, env, F);
+    ek = PEK_F::share(PreparedPoly<Fq>(F), env.n);
+}
 
-    MultiPoly<Fq> poly(1, 1);
-    vector<MultiPoly<Fq>> ell;
-    for (size_t i = 0; i < F.varCount(); ++i)
-    {
-        ell.push_back(poly);
-        ell.back().addTerm({0}, random_ZZ_p()); // Random coefficient for constant
-        ell.back().addTerm({1}, random_ZZ_p()); // Random coefficient for u^1
-    }
-    auto f = compose(F, ell);
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    KeyGen(pk, vk, ek, env, QuadraticPoly<Fq>(F));
+}
 
-    for (int i = 0; i < F.varCount(); ++i)
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const QuadraticPoly<Fq> &F)
+{
+    ek.kill();
+    KeyGenPublic(pk, vk, env, F);
+    ek = QEK_F::share(F, env.n);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, CEK_F &ek, Env &env, const Circuit<Fq> &F)
+{
+    ek.kill();
+    KeyGenPublic(pk, vk, env, F);
+    ek = CEK_F::share(F, env.n);
+}
+
+void KeyGen(PK_FV &pk, VK_FV &vk, EK_FV &ek, Env &env, const Vec<MultiPoly<Fq>> &F)
+{
+    long m;
+    int d;
+    SystemShape(m, d, F);
+    ek.kill();
+    KeyGenEnv(env, m, d);
+
+    pk.ell = PackedAffine::random(m);
+    pk.f.SetLength(F.length());
+    for (long j = 0; j < F.length(); ++j)
     {
-        pk.append(ell[i]);
+        pk.f[j] = pk.ell.compose(F[j]);
     }
 
-    vk.ell = pk;
-    vk.f = f;
-    for (int i = 0; i < env.k; ++i)
+    vk.ell = pk.ell;
+    vk.f = pk.f;
+    ek = EK_FV::share(F, env.n);
+}
+
+void KeyGen(PK_FV &pk, VK_FV &vk, LEK_F &ek, Env &env, const LinearForms<Fq> &F)
+{
+    ek.kill();
+    KeyGenEnv(env, F.varCount(), 1);
+
+    // f_j(u) = c_j + sum_i W_ji (c_i + s_i u) is read off W directly
+    long m = F.varCount();
+    pk.ell = PackedAffine::random(m);
+    pk.f.SetLength(F.outputCount());
+    for (long j = 0; j < pk.f.length(); ++j)
     {
-        ek.append(F);
+        Fq c0 = F.offset(j), c1(0);
+        for (long i = 0; i < m; ++i)
+        {
+            c0 += F.weight(j, i) * pk.ell.constant(i);
+            c1 += F.weight(j, i) * pk.ell.slope(i);
+        }
+        clear(pk.f[j]);
+        SetCoeff(pk.f[j], 0, c0);
+        SetCoeff(pk.f[j], 1, c1);
     }
+
+    vk.ell = pk.ell;
+    vk.f = pk.f;
+    ek = LEK_F::share(F, env.n);
 }
 
-void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, Vec<Fq> X)
+void UpdateKey(PK_F &pk, VK_F &vk, EK_F &ek, const Env &env, const MultiPoly<Fq> &delta)
 {
-    if (pk.length() == 0)
+    if (ek.length() == 0 || pk.ell.length() != env.m)
+        throw std::invalid_argument("UpdateKey needs the keys from KeyGen");
+    if (static_cast<long>(delta.varCount()) != env.m)
+        throw std::invalid_argument("delta must have the same variables as F");
+    if (delta.maxDegree() > env.d)
+        throw std::out_of_range("delta exceeds the degree of F; run KeyGen again");
+
+    // compose is linear in F, so f(F + delta) = f(F) + f(delta); only the
+    // ell_j of variables that occur in delta are touched
+    pk.f += pk.ell.composeTerms(delta);
+    vk.f = pk.f;
+
+    ek.modify([&](MultiPoly<Fq> &F) {
+        for (const auto &[e, c] : delta.terms())
+            F.addTerm(e, c);
+    });
+}
+
+// Shares of X together with the trapdoors a, alpha they are bound to
+static void ProbGenShares(Fq &a, Fq &alpha, Mat<Fq> &sigma, const Env &env, const PackedAffine &ell, const Vec<Fq> &X)
+{
+    if (ell.length() == 0)
         throw std::invalid_argument("Public key pk is empty");
 
     if (X.length() != env.m)
         throw std::invalid_argument("Length of X must match number of variables in pk");
 
     // Step 1: Sample a, alpha
-    ZZ_p a, alpha;
     do
     {
         a = random_ZZ_p();
     } while (IsZero(a));
 
-    ZZ k_bound = ZZ(env.k);
+    ZZ k_bound = ZZ(env.n); // alpha is never a share point
     do
     {
         alpha = random_ZZ_p();
@@ -71,11 +163,7 @@ void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, Vec<Fq> X
 
     // Step 2: pk(a)
     Vec<Fq> aa;
-    aa.SetLength(pk.length());
-    for (int i = 0; i < pk.length(); ++i)
-    {
-        aa[i] = pk[i].evaluate({a});
-    }
+    ell.evaluate(aa, a);
 
     Mat<Fq> r;
     r = random_mat_ZZ_p(env.t + 1, env.m);
@@ -118,8 +206,8 @@ void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, Vec<Fq> X
     SetCoeff(factor, 1, 1);
     b = factor * q; // b(x) = (x - alpha) * q(x), so b(alpha) = 0 and b(0) = 0
 
-    sigma.SetDims(env.k, env.m + 1);
-    for (int i = 0; i < env.k; ++i)
+    sigma.SetDims(env.n, env.m + 1);
+    for (int i = 0; i < env.n; ++i)
     {
         for (int j = 0; j < env.m; ++j)
         {
@@ -127,17 +215,14 @@ void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, Vec<Fq> X
         }
         eval(sigma[i][env.m], b, to_ZZ_p(i));
     }
+}
 
-    vk.a.SetLength(env.d);
+// g^{f(a)} and g^(alpha^i) for a fresh a, alpha
+static void ProbGenKey(VK_X &vk, const Env &env, const PK_F &pk, const Fq &a, const Fq &alpha)
+{
+    PowerMod(vk.gfa, env.g, rep(eval(pk.f, a)), env.fq);
     vk.alpha.SetLength(env.k - 1);
 
-    ZZ_p a_power(1);
-    for (int i = 0; i < env.d; ++i)
-    {
-        a_power *= a;
-        PowerMod(vk.a[i], env.g, rep(a_power), env.fq);
-    }
-
     ZZ_p alpha_power(1);
     for (int i = 0; i < env.k - 1; ++i)
     {
@@ -149,9 +234,243 @@ void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, Vec<Fq> X
     //vk.alpha_bk = alpha;
 }
 
-void Compute(Fq &pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env)
+void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, Vec<Fq> X)
+{
+    ZZ_p a, alpha;
+    ProbGenShares(a, alpha, sigma, env, pk.ell, X);
+    ProbGenKey(vk, env, pk, a, alpha);
+}
+
+void ProbGenPrivate(SK_X &sk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec<Fq> &X)
+{
+    ProbGenShares(sk.a, sk.alpha, sigma, env, pk.ell, X);
+}
+
+void ProbGenMulti(VK_XV &vk, Mat<Fq> &sigma, const Env &env, const PK_FV &pk, const Vec<Fq> &X)
+{
+    ZZ_p a, alpha;
+    ProbGenShares(a, alpha, sigma, env, pk.ell, X);
+
+    // r + k - 1 exponentiations of g share one table
+    long r = pk.f.length();
+    long bits = NumBits(env.ord);
+    FixedBaseExp gexp(env.g, env.fq, bits, FixedBaseExp::bestWindow(bits, r + env.k - 1));
+    vk.gfa.SetLength(r);
+    for (long j = 0; j < r; ++j)
+    {
+        gexp.power(vk.gfa[j], rep(eval(pk.f[j], a)));
+    }
+
+    vk.alpha.SetLength(env.k - 1);
+    ZZ_p alpha_power(1);
+    for (int i = 0; i < env.k - 1; ++i)
+    {
+        alpha_power *= alpha;
+        gexp.power(vk.alpha[i], rep(alpha_power));
+    }
+}
+
+void ProbGenBatch(Vec<VK_X> &vk, Vec<Mat<Fq>> &sigma, const Env &env, const PK_F &pk, const Vec<Vec<Fq>> &Xs)
+{
+    if (pk.ell.length() == 0)
+        throw std::invalid_argument("Public key pk is empty");
+
+    long N = Xs.length();
+    for (long n = 0; n < N; ++n)
+    {
+        if (Xs[n].length() != env.m)
+            throw std::invalid_argument("Length of X must match number of variables in pk");
+    }
+
+    // Step 1: Sample a, alpha for every input
+    Vec<Fq> a, alpha, alpha_top;
+    a.SetLength(N);
+    alpha.SetLength(N);
+    alpha_top.SetLength(N);
+    ZZ k_bound = ZZ(env.n);
+    for (long n = 0; n < N; ++n)
+    {
+        do
+        {
+            a[n] = random_ZZ_p();
+        } while (IsZero(a[n]));
+        do
+        {
+            alpha[n] = random_ZZ_p();
+        } while (rep(alpha[n]) < k_bound);
+        power(alpha_top[n], alpha[n], env.t + 1);
+    }
+
+    // One inversion for all alpha^(t+1)
+    Vec<Fq> inv_alpha;
+    BatchInverse(inv_alpha, alpha_top);
+
+    // Coefficients of every c_j side by side, input n in columns n*m..
+    // Row 0 holds X, rows 1..t are random and row t+1 makes c_j(alpha) = pk_j(a).
+    Mat<Fq> C = random_mat_ZZ_p(env.t + 2, N * env.m);
+    Vec<Fq> aa;
+    for (long n = 0; n < N; ++n)
+    {
+        pk.ell.evaluate(aa, a[n]);
+        for (int j = 0; j < env.m; ++j)
+        {
+            long col = n * env.m + j;
+            C[0][col] = Xs[n][j];
+            Fq acc = Xs[n][j];
+            Fq alpha_exp = alpha[n];
+            for (int i = 1; i <= env.t; ++i)
+            {
+                acc += C[i][col] * alpha_exp;
+                alpha_exp *= alpha[n];
+            }
+            C[env.t + 1][col] = inv_alpha[n] * (aa[j] - acc);
+        }
+    }
+    Mat<Fq> V, S;
+    Vandermonde(V, env.n, env.t + 2);
+    mul(S, V, C);
+
+    // b(x) = (x - alpha) * q(x) with q(0) = 0, one column per input
+    Mat<Fq> B;
+    B.SetDims(env.k, N);
+    for (long n = 0; n < N; ++n)
+    {
+        ZZ_pX q, factor;
+        random(q, env.k - 1);           // Random polynomial of degree k-2
+        SetCoeff(q, 0, 0);              // Set constant term of q to 0, so q(0) = 0
+        SetCoeff(factor, 0, -alpha[n]); // factor = (x - alpha)
+        SetCoeff(factor, 1, 1);
+        ZZ_pX b = factor * q;
+        for (int i = 0; i <= deg(b); ++i)
+        {
+            B[i][n] = coeff(b, i);
+        }
+    }
+    Mat<Fq> W, Z;
+    Vandermonde(W, env.n, env.k);
+    mul(Z, W, B);
+
+    long bits = NumBits(env.ord);
+    FixedBaseExp gexp(env.g, env.fq, bits, FixedBaseExp::bestWindow(bits, N * env.k));
+
+    vk.SetLength(N);
+    sigma.SetLength(N);
+    for (long n = 0; n < N; ++n)
+    {
+        sigma[n].SetDims(env.n, env.m + 1);
+        for (int i = 0; i < env.n; ++i)
+        {
+            for (int j = 0; j < env.m; ++j)
+            {
+                sigma[n][i][j] = S[i][n * env.m + j];
+            }
+            sigma[n][i][env.m] = Z[i][n];
+        }
+
+        gexp.power(vk[n].gfa, rep(eval(pk.f, a[n])));
+        vk[n].alpha.SetLength(env.k - 1);
+
+        ZZ_p alpha_power(1);
+        for (int i = 0; i < env.k - 1; ++i)
+        {
+            alpha_power *= alpha[n];
+            gexp.power(vk[n].alpha[i], rep(alpha_power));
+        }
+    }
+}
+
+void ProbGenOffline(PRE_X &pre, const Env &env, const PK_F &pk)
 {
-    if (idx < 0 || idx >= env.k)
+    if (pk.ell.length() != env.m)
+        throw std::invalid_argument("Public key pk must have one polynomial per variable");
+
+    do
+    {
+        pre.a = random_ZZ_p();
+    } while (IsZero(pre.a));
+
+    ZZ k_bound = ZZ(env.n);
+    do
+    {
+        pre.alpha = random_ZZ_p();
+    } while (rep(pre.alpha) < k_bound);
+
+    // Coefficients of c_j with X = 0 in columns 0..m-1, rows 1..t random
+    // and row t+1 making c_j(alpha) = pk_j(a); the X part is folded into w
+    Mat<Fq> C;
+    C.SetDims(env.t + 2, env.m);
+    Fq alpha_top(1);
+    for (int s = 1; s <= env.t + 1; ++s)
+    {
+        alpha_top *= pre.alpha;
+    }
+    Fq inv_alpha = inv(alpha_top);
+    Vec<Fq> aa;
+    pk.ell.evaluate(aa, pre.a);
+    for (int j = 0; j < env.m; ++j)
+    {
+        Fq acc(0);
+        Fq alpha_exp = pre.alpha;
+        for (int s = 1; s <= env.t; ++s)
+        {
+            C[s][j] = random_ZZ_p();
+            acc += C[s][j] * alpha_exp;
+            alpha_exp *= pre.alpha;
+        }
+        C[env.t + 1][j] = inv_alpha * (aa[j] - acc);
+    }
+    Mat<Fq> V, S;
+    Vandermonde(V, env.n, env.t + 2);
+    mul(S, V, C);
+
+    // b(x) = (x - alpha) * q(x) with q(0) = 0, shared in column m
+    ZZ_pX q, factor;
+    random(q, env.k - 1);
+    SetCoeff(q, 0, 0);
+    SetCoeff(factor, 0, -pre.alpha);
+    SetCoeff(factor, 1, 1);
+    ZZ_pX b = factor * q;
+
+    pre.base.SetDims(env.n, env.m + 1);
+    pre.w.SetLength(env.n);
+    for (int i = 0; i < env.n; ++i)
+    {
+        for (int j = 0; j < env.m; ++j)
+        {
+            pre.base[i][j] = S[i][j];
+        }
+        eval(pre.base[i][env.m], b, to_ZZ_p(i));
+        // c_j(i) = base[i][j] + X_j * (1 - i^(t+1) / alpha^(t+1))
+        pre.w[i] = 1 - V[i][env.t + 1] * inv_alpha;
+    }
+
+    ProbGenKey(pre.vk, env, pk, pre.a, pre.alpha);
+}
+
+void ProbGenOnline(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PRE_X &pre, const Vec<Fq> &X)
+{
+    if (X.length() != env.m)
+        throw std::invalid_argument("Length of X must match number of variables in pk");
+    if (pre.base.NumRows() != env.n || pre.base.NumCols() != env.m + 1)
+        throw std::invalid_argument("Precomputation does not match env");
+
+    sigma.SetDims(env.n, env.m + 1);
+    for (int i = 0; i < env.n; ++i)
+    {
+        for (int j = 0; j < env.m; ++j)
+        {
+            mul(sigma[i][j], X[j], pre.w[i]);
+            sigma[i][j] += pre.base[i][j];
+        }
+        sigma[i][env.m] = pre.base[i][env.m];
+    }
+    vk = pre.vk;
+}
+
+template <typename Poly>
+void Compute(Fq &pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env)
+{
+    if (idx < 0 || idx >= env.n)
         throw std::out_of_range("Index out of range in Compute");
 
     if (ek_i.varCount() != sigma_i.length() - 1)
@@ -166,6 +485,43 @@ void Compute(Fq &pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &sigma_
     pi_i = ek_i.evaluate(eval_points) + sigma_i[env.m] + theta_i;
 }
 
+template void Compute(Fq &, int, const MultiPoly<Fq> &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Fq &, int, const PreparedPoly<Fq> &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Fq &, int, const QuadraticPoly<Fq> &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Fq &, int, const Circuit<Fq> &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Fq &, int, const MappedPoly &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Fq &, int, const StreamedPoly &, const Vec<Fq> &, const Fq &, const Env &);
+
+template <typename Polys>
+void ComputeMulti(Vec<Fq> &pi_i, int idx, const Polys &ek_i, const Vec<Fq> &sigma_i, const Vec<Fq> &theta_i, const Env &env)
+{
+    if (idx < 0 || idx >= env.n)
+        throw std::out_of_range("Index out of range in Compute");
+
+    if (sigma_i.length() != env.m + 1)
+        throw std::invalid_argument("Length of sigma_i must match number of variables in ek_i");
+
+    vector<Fq> eval_points(env.m);
+    for (int i = 0; i < env.m; ++i)
+    {
+        eval_points[i] = sigma_i[i];
+    }
+
+    vector<Fq> vals;
+    EvaluateAll(vals, ek_i, eval_points);
+    long r = vals.size();
+    if (theta_i.length() != r)
+        throw std::invalid_argument("theta_i needs one mask share per output");
+    pi_i.SetLength(r);
+    for (long j = 0; j < r; ++j)
+    {
+        pi_i[j] = vals[j] + sigma_i[env.m] + theta_i[j];
+    }
+}
+
+template void ComputeMulti(Vec<Fq> &, int, const Vec<MultiPoly<Fq>> &, const Vec<Fq> &, const Vec<Fq> &, const Env &);
+template void ComputeMulti(Vec<Fq> &, int, const LinearForms<Fq> &, const Vec<Fq> &, const Vec<Fq> &, const Env &);
+
 bool Verify(const VK_F &vk_f, const VK_theta &vk_theta, Vec<Fq> pi, const Env &env)
 {
     if (pi.length() != env.k)
@@ -182,44 +538,287 @@ bool Verify(const VK_F &vk_f, const VK_theta &vk_theta, Vec<Fq> pi, const Env &e
     ZZ_pX phi = interpolate(k_vec, pi);
     ZZ res1 = compute_g_fa(phi, vk_theta.vkx.alpha, env.g, env.fq);
 
-    ZZ_pX f = toZZ_pX(vk_f.f);
-    ZZ res2 = compute_g_fa(f, vk_theta.vkx.a, env.g, env.fq);
-    MulMod(res2, res2, vk_theta.gbeta, env.fq);
-
-    if (res1 != res2)
+    if (res1 != vk_theta.target)
     {
-        std::cerr << "Verification failed: vk_f.f evaluated at vk_x.a does not match vk_x.alpha" << std::endl;
+        std::cerr << "Verification failed: phi evaluated at vk_x.alpha does not match vk_theta.target" << std::endl;
         return false;
     }
     //cout << "Verification successful." << endl;
     return true;
 }
 
+bool VerifyAt(const VK_F &vk_f, const VK_theta &vk_theta, const Vec<Fq> &pi, const Vec<long> &idx, const Env &env)
+{
+    if (pi.length() != idx.length())
+        throw std::invalid_argument("pi needs one entry per responder");
+
+    // phi through the first k responders
+    Vec<Fq> pts, vals;
+    ResponderPoints(pts, idx, env.k, env.n);
+    vals.SetLength(env.k);
+    for (int r = 0; r < env.k; ++r)
+    {
+        vals[r] = pi[r];
+    }
+
+    ZZ_pX phi = interpolate(pts, vals);
+    ZZ res1 = compute_g_fa(phi, vk_theta.vkx.alpha, env.g, env.fq);
+
+    if (res1 != vk_theta.target)
+    {
+        std::cerr << "Verification failed: phi evaluated at vk_x.alpha does not match vk_theta.target" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VerifyRobust(Fq &res, Vec<long> &bad, const VK_F &vk_f, const VK_theta &vk_theta, const SK_theta &sk, const Vec<Fq> &pi, const Vec<long> &idx, const Env &env)
+{
+    if (pi.length() != idx.length())
+        throw std::invalid_argument("pi needs one entry per responder");
+    if (idx.length() < env.k)
+        throw std::invalid_argument("Fewer responses than the k the protocol needs");
+
+    // phi has degree k-1
+    ZZ_pX phi;
+    if (!DecodeResponse(phi, bad, pi, idx, env.k, env.n))
+    {
+        std::cerr << "Verification failed: too many faulty responses to decode" << std::endl;
+        return false;
+    }
+
+    ZZ res1 = compute_g_fa(phi, vk_theta.vkx.alpha, env.g, env.fq);
+    if (res1 != vk_theta.target)
+    {
+        std::cerr << "Verification failed: phi evaluated at vk_x.alpha does not match vk_theta.target" << std::endl;
+        return false;
+    }
+    eval(res, phi, ZZ_p(0));
+    res -= sk;
+    return true;
+}
+
+bool VerifyMulti(const VK_FV &vk_f, const VK_thetaV &vk_theta, const Mat<Fq> &pi, const Env &env)
+{
+    if (pi.NumRows() != env.k || pi.NumCols() != vk_theta.target.length())
+        throw std::invalid_argument("pi must have k rows and one column per output");
+
+    Vec<Fq> phi0;
+    if (!FoldedPowerCheck(phi0, pi, vk_theta.vkx.alpha, vk_theta.target, env.g, env.fq))
+    {
+        std::cerr << "Verification failed: phi evaluated at vk_x.alpha does not match vk_theta.target" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VerifyPrivate(const VK_F &vk_f, const DVK_theta &vk_theta, const Vec<Fq> &pi, const Env &env)
+{
+    if (pi.length() != env.k)
+        throw std::invalid_argument("Length of pi must match k in Env");
+
+    // The exponents of both sides of Verify, compared directly in the field;
+    // phi(alpha) comes straight from the shares without interpolating phi
+    Vec<Fq> w;
+    ShareWeights(w, env.k, vk_theta.skx.alpha);
+    Fq phi_alpha;
+    InnerProduct(phi_alpha, w, pi);
+    if (phi_alpha != eval(vk_f.f, vk_theta.skx.a) + vk_theta.z_alpha)
+    {
+        std::cerr << "Verification failed: phi(alpha) does not match f(a) + z(alpha)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VerifyBatch(std::vector<bool> &ok, const VK_F &vk_f, const Vec<VK_theta> &vk_theta, const Vec<Vec<Fq>> &pi, const Env &env)
+{
+    long N = pi.length();
+    if (vk_theta.length() != N)
+        throw std::invalid_argument("VerifyBatch needs one vk_theta per instance");
+    for (long n = 0; n < N; ++n)
+    {
+        if (pi[n].length() != env.k)
+            throw std::invalid_argument("Length of pi must match k in Env");
+    }
+
+    // Coefficients of every phi at once: column n of Phi interpolates pi[n]
+    Mat<Fq> M, P, Phi;
+    InterpolationMatrix(M, env.k);
+    P.SetDims(env.k, N);
+    for (long n = 0; n < N; ++n)
+    {
+        for (int i = 0; i < env.k; ++i)
+        {
+            P[i][n] = pi[n][i];
+        }
+    }
+    mul(Phi, M, P);
+
+    // Instance n holds iff g^{phi(0)} * prod alpha_i^{phi_i} * target^-1 == 1
+    Vec<ZZ> gExp;
+    Vec<Vec<ZZ>> bases, exps;
+    gExp.SetLength(N);
+    bases.SetLength(N);
+    exps.SetLength(N);
+    ZZ minus_one = env.ord - 1;
+    for (long n = 0; n < N; ++n)
+    {
+        const VK_X &vkx = vk_theta[n].vkx;
+        if (vkx.alpha.length() < env.k - 1)
+            throw std::invalid_argument("vk_x does not match k in Env");
+
+        gExp[n] = rep(Phi[0][n]);
+        for (int i = 1; i < env.k; ++i)
+        {
+            if (IsZero(Phi[i][n]))
+                continue;
+            bases[n].append(vkx.alpha[i - 1]);
+            exps[n].append(rep(Phi[i][n]));
+        }
+        bases[n].append(vk_theta[n].target);
+        exps[n].append(minus_one);
+    }
+
+    if (!BatchProductCheck(ok, env.g, gExp, bases, exps, env.ord, env.fq))
+    {
+        long bad = 0;
+        for (long n = 0; n < N; ++n)
+        {
+            if (!ok[n])
+            {
+                ++bad;
+            }
+        }
+        std::cerr << "Verification failed for " << bad << " of " << N << " instances" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void MaskGen(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env &env, const VK_X &vk_x)
 {
     random(sk);
     vk.vkx = vk_x;
-    PowerMod(vk.gbeta, env.g, rep(sk), env.fq);
 
-    theta.SetLength(env.k);
+    theta.SetLength(env.n);
     ZZ_pX z;
     random(z, env.k);        // Random polynomial of degree k-1
     SetCoeff(z, 0, sk);           // Set constant term of z to beta,
-    for (int i = 0; i < env.k; ++i)
+    for (int i = 0; i < env.n; ++i)
     {
         eval(theta[i], z, to_ZZ_p(i));
     }
-    PowerMod(vk.gbeta, env.g, rep(sk), env.fq);
+    // target = g^{f(a)} * g^beta * prod (g^{alpha^i})^{z_i}
+    PowerMod(vk.target, env.g, rep(sk), env.fq);
+    MulMod(vk.target, vk.target, vk_x.gfa, env.fq);
     
     ZZ tmp;
     for (int i = 0; i < env.k - 1; ++i)
     {
         PowerMod(tmp, vk_x.alpha[i], rep(z[i+1]), env.fq);
-        MulMod(vk.gbeta, vk.gbeta, tmp, env.fq);
+        MulMod(vk.target, vk.target, tmp, env.fq);
     }
     //vk.beta = sk;
 }
 
+void MaskGenMulti(VK_thetaV &vk, Vec<Fq> &sk, Mat<Fq> &theta, const Env &env, const VK_XV &vk_x)
+{
+    long r = vk_x.gfa.length();
+    if (vk_x.alpha.length() < env.k - 1)
+        throw std::invalid_argument("vk_x does not match k in Env");
+
+    // An independent beta_j and z_j for every output; each target is one
+    // multi-exponentiation over g and the alpha powers
+    vk.vkx = vk_x;
+    vk.target.SetLength(r);
+    sk.SetLength(r);
+    theta.SetDims(env.n, r);
+
+    Vec<ZZ> bases, exps;
+    bases.SetLength(env.k);
+    exps.SetLength(env.k);
+    bases[0] = env.g;
+    for (int i = 1; i < env.k; ++i)
+    {
+        bases[i] = vk_x.alpha[i - 1];
+    }
+
+    ZZ_pX z;
+    for (long j = 0; j < r; ++j)
+    {
+        random(sk[j]);
+        random(z, env.k);
+        SetCoeff(z, 0, sk[j]);
+        for (int i = 0; i < env.n; ++i)
+        {
+            eval(theta[i][j], z, to_ZZ_p(i));
+        }
+        for (int i = 0; i < env.k; ++i)
+        {
+            exps[i] = rep(coeff(z, i));
+        }
+        MulMod(vk.target[j], MultiExp(bases, exps, env.fq), vk_x.gfa[j], env.fq);
+    }
+}
+
+void MaskGenOffline(PRE_theta &pre, const Env &env)
+{
+    random(pre.beta);
+    ZZ_pX z;
+    random(z, env.k);         // Random polynomial of degree k-1
+    SetCoeff(z, 0, pre.beta); // Set constant term of z to beta
+
+    pre.theta.SetLength(env.n);
+    for (int i = 0; i < env.n; ++i)
+    {
+        eval(pre.theta[i], z, to_ZZ_p(i));
+    }
+
+    pre.z.SetLength(env.k - 1);
+    for (int i = 0; i < env.k - 1; ++i)
+    {
+        pre.z[i] = rep(coeff(z, i + 1));
+    }
+    PowerMod(pre.gbeta, env.g, rep(pre.beta), env.fq);
+}
+
+void MaskGenOnline(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env &env, const PRE_theta &pre, const VK_X &vk_x)
+{
+    if (pre.theta.length() != env.n || vk_x.alpha.length() != env.k - 1)
+        throw std::invalid_argument("Precomputation does not match env");
+
+    // target = g^{f(a)} * g^beta * prod (g^{alpha^i})^{z_i}
+    vk.vkx = vk_x;
+    MulMod(vk.target, pre.gbeta, vk_x.gfa, env.fq);
+    ZZ tmp;
+    for (int i = 0; i < env.k - 1; ++i)
+    {
+        PowerMod(tmp, vk_x.alpha[i], pre.z[i], env.fq);
+        MulMod(vk.target, vk.target, tmp, env.fq);
+    }
+    sk = pre.beta;
+    theta = pre.theta;
+}
+
+void MaskGenPrivate(DVK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env &env, const SK_X &sk_x)
+{
+    random(sk);
+    vk.skx = sk_x;
+
+    theta.SetLength(env.n);
+    ZZ_pX z;
+    random(z, env.k);   // Random polynomial of degree k-1
+    SetCoeff(z, 0, sk); // Set constant term of z to beta
+    for (int i = 0; i < env.n; ++i)
+    {
+        eval(theta[i], z, to_ZZ_p(i));
+    }
+
+    // Verify's target is g^{f(a) + z(alpha)}
+    eval(vk.z_alpha, z, sk_x.alpha);
+}
+
 void Reconstruct(Fq &res, const SK_theta &sk, const Vec<Fq> &pi, const Env &env)
 {
     Vec<Fq> k_vec;
@@ -233,4 +832,113 @@ void Reconstruct(Fq &res, const SK_theta &sk, const Vec<Fq> &pi, const Env &env)
     eval(res, phi, ZZ_p(0));
     res -= sk;
 }
+
+void ReconstructAt(Fq &res, const SK_theta &sk, const Vec<Fq> &pi, const Vec<long> &idx, const Env &env)
+{
+    if (pi.length() != idx.length())
+        throw std::invalid_argument("pi needs one entry per responder");
+
+    // phi(0) is a fixed combination of the responders' shares
+    Vec<Fq> pts, w;
+    ResponderPoints(pts, idx, env.k, env.n);
+    LagrangeWeights(w, pts, ZZ_p(0));
+    clear(res);
+    for (int r = 0; r < env.k; ++r)
+    {
+        res += w[r] * pi[r];
+    }
+    res -= sk;
+}
+
+void ReconstructMulti(Vec<Fq> &res, const Vec<Fq> &sk, const Mat<Fq> &pi, const Env &env)
+{
+    long r = sk.length();
+    if (pi.NumRows() != env.k || pi.NumCols() != r)
+        throw std::invalid_argument("pi must have k rows and one column per output");
+
+    Vec<Fq> w;
+    ShareWeights(w, env.k, ZZ_p(0));
+    res.SetLength(r);
+    for (long j = 0; j < r; ++j)
+    {
+        clear(res[j]);
+        for (int i = 0; i < env.k; ++i)
+        {
+            res[j] += w[i] * pi[i][j];
+        }
+        res[j] -= sk[j];
+    }
+}
+
+void writeBinary(std::ostream &out, const PK_F &pk)
+{
+    ::writeBinary(out, pk.ell);
+    ::writeBinary(out, pk.f);
+}
+
+void readBinary(std::istream &in, PK_F &pk)
+{
+    ::readBinary(in, pk.ell);
+    ::readBinary(in, pk.f);
+}
+
+void writeBinary(std::ostream &out, const VK_F &vk)
+{
+    ::writeBinary(out, vk.ell);
+    ::writeBinary(out, vk.f);
+}
+
+void readBinary(std::istream &in, VK_F &vk)
+{
+    ::readBinary(in, vk.ell);
+    ::readBinary(in, vk.f);
+}
+
+void writeBinary(std::ostream &out, const VK_X &vk)
+{
+    ::writeBinary(out, vk.gfa);
+    ::writeBinary(out, vk.alpha);
+}
+
+void readBinary(std::istream &in, VK_X &vk)
+{
+    ::readBinary(in, vk.gfa);
+    ::readBinary(in, vk.alpha);
+}
+
+void writeBinary(std::ostream &out, const VK_theta &vk)
+{
+    writeBinary(out, vk.vkx);
+    ::writeBinary(out, vk.target);
+}
+
+void readBinary(std::istream &in, VK_theta &vk)
+{
+    readBinary(in, vk.vkx);
+    ::readBinary(in, vk.target);
+}
+
+void writeBinary(std::ostream &out, const SK_X &sk)
+{
+    ::writeBinary(out, sk.a);
+    ::writeBinary(out, sk.alpha);
+}
+
+void readBinary(std::istream &in, SK_X &sk)
+{
+    ::readBinary(in, sk.a);
+    ::readBinary(in, sk.alpha);
+}
+
+void writeBinary(std::ostream &out, const DVK_theta &vk)
+{
+    writeBinary(out, vk.skx);
+    ::writeBinary(out, vk.z_alpha);
+}
+
+void readBinary(std::istream &in, DVK_theta &vk)
+{
+    readBinary(in, vk.skx);
+    ::readBinary(in, vk.z_alpha);
+}
 }
\ No newline at end of file
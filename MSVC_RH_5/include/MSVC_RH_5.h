@@ -1,6 +1,15 @@
 #pragma once
 #include "helper.h"
 #include "MultiPoly.h"
+#include "EvalKey.h"
+#include "PreparedPoly.h"
+#include "QuadraticPoly.h"
+#include "LinearForms.h"
+#include "Circuit.h"
+#include "Serialize.h"
+#include "StreamedPoly.h"
+#include "PrecomputePool.h"
+#include "IncrementalEvaluator.h"
 namespace RH5 {
 
 struct Env {
@@ -12,25 +21,137 @@ struct Env {
     int k;
     int d;
     int m;
+    int n; // servers that receive shares; KeyGen raises it to at least k
 };
 
 using PK_F = ZZ;
 using VK_F = ZZ; 
-using EK_F = Vec<MultiPoly<Fq>>;
+using EK_F = EvalKey<MultiPoly<Fq>>;
+using PEK_F = EvalKey<PreparedPoly<Fq>>; // preprocessed server key
+using QEK_F = EvalKey<QuadraticPoly<Fq>>; // dense server key for d <= 2
+using EK_FV = EvalKey<Vec<MultiPoly<Fq>>>; // one key for all outputs of a vector-valued F
+using LEK_F = EvalKey<LinearForms<Fq>>; // dense key for r linear forms, d = 1
+using CEK_F = EvalKey<Circuit<Fq>>; // circuit key; server cost tracks the gate count
 using VK_X = ZZ;
 using VK_theta = ZZ;
 using SK_theta = Fq;
 
+// Input-independent part of one ProbGen: the shares with X = 0, including
+// the b shares and the zero-sharing masks, and g^alpha
+struct PRE_X {
+    Mat<Fq> sigma;
+    VK_X vk;
+};
+
+// One MaskGen drawn ahead of time: beta and its degree dt sharing
+struct PRE_theta {
+    Fq beta;
+    Vec<Fq> theta;
+};
+
 void Initialize(Env &env, int t, int secpar = 256);
 
 void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F);
 
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+
+// Dense quadratic key for d <= 2. The MultiPoly form is converted once; the
+// QuadraticPoly form never builds MultiPoly terms but still stores all
+// (m+1)(m+2)/2 coefficients, see QuadraticPoly.h.
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+void KeyGen(PK_F &pk, VK_F &vk, QEK_F &ek, Env &env, const QuadraticPoly<Fq> &F);
+
+// F as an arithmetic circuit; d is its declared degree bound
+void KeyGen(PK_F &pk, VK_F &vk, CEK_F &ek, Env &env, const Circuit<Fq> &F);
+
+// Vector-valued F = (F_1, ..., F_r) over the same variables; d is the
+// largest degree among the outputs
+void KeyGen(PK_F &pk, VK_F &vk, EK_FV &ek, Env &env, const Vec<MultiPoly<Fq>> &F);
+void KeyGen(PK_F &pk, VK_F &vk, LEK_F &ek, Env &env, const LinearForms<Fq> &F);
+
 void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PK_F &pk, const Vec<Fq> &X);
 
+// Shares and verification keys for many inputs at once. The Vandermonde
+// table over the share points and the g-exponentiation table are built once
+// and reused for every input.
+void ProbGenBatch(Vec<VK_X> &vk, Vec<Mat<Fq>> &sigma, const Env& env, const PK_F &pk, const Vec<Vec<Fq>> &Xs);
+
 void MaskGen(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env& env, const VK_X &vk_x);
 
-void Compute(Vec<Fq> & pi_i, int idx, const MultiPoly<Fq> &ek_i, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env);
+// Offline/online MaskGen. Nothing in an RH5 mask depends on the request,
+// so MaskGenOffline does all of it and MaskGenOnline only hands it out.
+void MaskGenOffline(PRE_theta &pre, const Env& env);
+void MaskGenOnline(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env& env, const PRE_theta &pre, const VK_X &vk_x);
+
+// Offline/online ProbGen. ProbGenOffline does all sampling, sharing and the
+// exponentiation; ProbGenOnline adds X_j to every share of c_j, O(k*m).
+// Every PRE_X must be consumed by exactly one ProbGenOnline call.
+void ProbGenOffline(PRE_X &pre, const Env& env, const PK_F &pk);
+void ProbGenOnline(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PRE_X &pre, const Vec<Fq> &X);
+
+template <typename Poly>
+void Compute(Vec<Fq> & pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env);
 
 bool Verify(const VK_F &vk_f, const VK_X & vk_x, const Mat<Fq> &pi, const Env &env);
 
-void Reconstruct(Fq & res, const SK_theta &sk, const Mat<Fq> &pi, const Env &env);}
\ No newline at end of file
+// Verify N instances with one small-exponent batch test; ok[n] flags each instance
+bool VerifyBatch(std::vector<bool> &ok, const VK_F &vk_f, const Vec<VK_X> &vk_x, const Vec<Mat<Fq>> &pi, const Env &env);
+
+void Reconstruct(Fq & res, const SK_theta &sk, const Mat<Fq> &pi, const Env &env);
+
+// Straggler-tolerant Verify and Reconstruct. With env.n > k servers holding
+// shares, any k responses suffice: pi[r] is the response of server idx[r],
+// and the first k rows are used.
+bool VerifyAt(const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+void ReconstructAt(Fq &res, const SK_theta &sk, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+// Error-correcting Verify and Reconstruct for more than k responses. The
+// responses are decoded as Reed-Solomon codewords (phi of degree dt, psi of
+// degree k-1), which corrects up to (|idx| - k) / 2 wrong rows without a
+// rerun. bad lists the servers whose rows were corrected, and res is F(X)
+// if the check on the decoded values passes.
+bool VerifyRobust(Fq &res, Vec<long> &bad, const VK_F &vk_f, const VK_X &vk_x, const SK_theta &sk, const Mat<Fq> &pi, const Vec<long> &idx, const Env &env);
+
+// Vector-valued F. One ProbGen serves all r outputs; each output gets its
+// own mask from MaskGenMulti (theta is n x r, sk holds the r betas), so the
+// outputs stay hidden from each other. pi_i holds (phi_j, psi_j) for every
+// output side by side, and VerifyMulti folds the r checks with random
+// weights into a single one.
+void MaskGenMulti(VK_theta &vk, Vec<Fq> &sk, Mat<Fq> &theta, const Env &env, const VK_X &vk_x, long r);
+// Polys is Vec<MultiPoly<Fq>> (EK_FV) or LinearForms<Fq> (LEK_F)
+template <typename Polys>
+void ComputeMulti(Vec<Fq> &pi_i, int idx, const Polys &ek_i, const Vec<Fq> &sigma_i, const Vec<Fq> &theta_i, const Env &env);
+bool VerifyMulti(const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Env &env);
+void ReconstructMulti(Vec<Fq> &res, const Vec<Fq> &sk, const Mat<Fq> &pi, const Env &env);
+
+// Incremental session for inputs that change in a few coordinates. The
+// sharings of c_1..c_m persist between requests and SessionUpdate re-shares
+// only the coordinates in vars; b, a, e and theta are fresh for every
+// request, so each response is masked exactly as after ProbGen.
+//
+// vars is sent to every server in the clear, so unlike ProbGen a session
+// tells the servers which coordinates of X were re-shared between requests,
+// though not their values. With cover > 0 vars is padded with random
+// unchanged coordinates to at least cover entries, which hides which of
+// them changed and, up to cover, how many; cover = m re-shares everything.
+struct Session {
+    Vec<Fq> X;     // current input
+    long cover = 0; // minimum number of coordinates re-shared per update
+};
+
+// Opens a session with a full ProbGen on X
+void SessionStart(Session &s, VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec<Fq> &X);
+
+// Moves the session to input X. vars lists, ascending, the coordinates that
+// changed plus any cover padding, and delta is n x (|vars| + 3): the new
+// shares of those c_j, then b, a and e.
+void SessionUpdate(Session &s, VK_X &vk, Vec<long> &vars, Mat<Fq> &delta, const Env &env, const PK_F &pk, const Vec<Fq> &X);
+
+// Server side of a session. state is built once per server from its key,
+// IncrementalEvaluator<Fq>(ek[i]); ComputeStart evaluates F as Compute does
+// and ComputeUpdate re-evaluates only the terms touching a changed variable.
+void ComputeStart(Vec<Fq> &pi_i, IncrementalEvaluator<Fq> &state, int idx, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env);
+
+void ComputeUpdate(Vec<Fq> &pi_i, IncrementalEvaluator<Fq> &state, int idx, const Vec<long> &vars, const Vec<Fq> &delta_i, const Fq &theta_i, const Env &env);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "MSVC_RH_5.h"
+
+// Packed variant of RH5: ell inputs share one round of k servers.
+//
+// Input s sits at slot point -(s+1) of every sharing polynomial, and the
+// random anchors of a sharing sit at -(ell+1), -(ell+2), ..., so neither
+// collides with the share points 0..k-1. The c_j and b polynomials have
+// degree t+ell-1, phi = F(c) + a + theta has degree d(t+ell-1) and
+// psi = b*phi + e has degree (d+1)(t+ell-1), which fixes
+// k = (d+1)(t+ell-1)+1. Each server evaluates F once per ell inputs.
+namespace RH5 {
+namespace Packed {
+
+// The RH5 group parameters; every packed round goes to exactly n = k servers
+struct Env : RH5::Env {
+    int ell;
+    // Lagrange maps from the anchor values of a sharing to its k shares,
+    // for degree t+ell-1 (c_j, b), d(t+ell-1) (a, theta) and k-1 (e)
+    Mat<Fq> shareC;
+    Mat<Fq> sharePhi;
+    Mat<Fq> sharePsi;
+    // ell x k map from the k shares to the slot values
+    Mat<Fq> toSlots;
+};
+
+using PK_F = ZZ;
+using VK_F = ZZ;
+using EK_F = EvalKey<MultiPoly<Fq>>;
+using PEK_F = EvalKey<PreparedPoly<Fq>>; // preprocessed server key
+using VK_X = Vec<ZZ>;      // g^{alpha_s} for every slot
+using VK_theta = Vec<ZZ>;
+using SK_theta = Vec<Fq>;  // beta_s for every slot
+
+void Initialize(Env &env, int t, int ell, int secpar = 256);
+
+void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F);
+
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F);
+
+// Shares of exactly ell inputs; sigma has the k x (m+3) layout of RH5
+void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env& env, const PK_F &pk, const Vec<Vec<Fq>> &Xs);
+
+void MaskGen(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env& env, const VK_X &vk_x);
+
+template <typename Poly>
+void Compute(Vec<Fq> & pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env);
+
+// Checks g^{psi(slot)} == (g^{alpha_s})^{phi(slot)} for every slot at once
+bool Verify(const VK_F &vk_f, const VK_X & vk_x, const Mat<Fq> &pi, const Env &env);
+
+// res[s] = F(X_s) for every slot
+void Reconstruct(Vec<Fq> & res, const SK_theta &sk, const Mat<Fq> &pi, const Env &env);
+}
+}
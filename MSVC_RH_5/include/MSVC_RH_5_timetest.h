@@ -1,5 +1,8 @@
 #pragma once
 #include "MSVC_RH_5.h"
+#include "Workload.h"
+#include "MSVC_RH_5_packed.h"
+#include "StragglerSim.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -7,7 +10,21 @@
 namespace RH5 {
 
 // Function to run simple timing tests for MSVC_RH_5
-TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false);
+TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false, const WorkloadSpec &workload = WorkloadSpec());
 
-SimpleTimingResult runSingleTest(int d, int m, int t, int secpar);
-}
\ No newline at end of file
+SimpleTimingResult runSingleTest(int d, int m, int t, int secpar, const WorkloadSpec &workload = WorkloadSpec());
+
+// Timing test for the packed variant; all times are per input (divided by ell)
+TestResultData MSVC_RH_5_PACKED_TIMETEST(int d, int m, int t, int ell, int secpar, int iterations = 10, bool silent = false);
+
+SimpleTimingResult runSinglePackedTest(int d, int m, int t, int ell, int secpar);
+
+// Straggler timing test: shares go to k + spare servers whose responses
+// arrive after their compute time plus a latency drawn from `latency`
+// (cycled over the servers). Verify and Reconstruct use the first k to
+// arrive. compute_time is the wait for the k-th response; the summary also
+// shows the wait for servers 0..k-1 alone, i.e. without spares.
+TestResultData MSVC_RH_5_FIRSTK_TIMETEST(int d, int m, int t, int spare, const std::vector<LatencyModel> &latency, int secpar, int iterations = 10, bool silent = false);
+
+SimpleTimingResult runSingleFirstKTest(int d, int m, int t, int spare, const std::vector<LatencyModel> &latency, int secpar, uint64_t seed, double &no_spare_ms);
+}
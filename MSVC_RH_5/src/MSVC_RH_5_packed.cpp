@@ -0,0 +1,232 @@
+#include "MSVC_RH_5_packed.h"
+
+namespace RH5 {
+namespace Packed {
+
+void Initialize(Env &env, int t, int ell, int secpar)
+{
+    if (ell < 1)
+        throw std::invalid_argument("Packed RH5 needs at least one slot");
+
+    RH5::Initialize(env, t, secpar);
+    env.ell = ell;
+    env.k = 0;
+}
+
+// M[i][r] maps the values at the anchors -1, -2, ..., -anchors (slots
+// first) of a polynomial of degree < anchors to its value at share point i
+static void AnchorMatrix(Mat<Fq> &M, long k, long anchors)
+{
+    Vec<Fq> pts, w;
+    pts.SetLength(anchors);
+    for (long r = 0; r < anchors; ++r)
+    {
+        pts[r] = -to_ZZ_p(r + 1);
+    }
+    M.SetDims(k, anchors);
+    for (long i = 0; i < k; ++i)
+    {
+        LagrangeWeights(w, pts, to_ZZ_p(i));
+        for (long r = 0; r < anchors; ++r)
+        {
+            M[i][r] = w[r];
+        }
+    }
+}
+
+// Everything KeyGen produces except the server evaluation key
+static void KeyGenPublic(PK_F &pk, VK_F &vk, Env &env, const MultiPoly<Fq> &F)
+{
+    if (F.varCount() == 0 || F.maxDegree() < 1)
+        throw std::invalid_argument("Invalid polynomial F");
+
+    env.m = F.varCount();
+    env.d = F.maxDegree();
+    long deg_c = env.t + env.ell - 1;
+    env.k = (env.d + 1) * deg_c + 1;
+    env.n = env.k;
+
+    AnchorMatrix(env.shareC, env.k, deg_c + 1);
+    AnchorMatrix(env.sharePhi, env.k, env.d * deg_c + 1);
+    AnchorMatrix(env.sharePsi, env.k, env.k);
+
+    Vec<Fq> w;
+    env.toSlots.SetDims(env.ell, env.k);
+    for (int s = 0; s < env.ell; ++s)
+    {
+        ShareWeights(w, env.k, -to_ZZ_p(s + 1));
+        env.toSlots[s] = w;
+    }
+
+    pk = 0;
+    vk = 0;
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, EK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F);
+    ek = EK_F::share(F, env.k);
+}
+
+void KeyGen(PK_F &pk, VK_F &vk, PEK_F &ek, Env &env, const MultiPoly<Fq> &F)
+{
+    KeyGenPublic(pk, vk, env, F);
+    ek = PEK_F::share(PreparedPoly<Fq>(F), env.k);
+}
+
+// Shares of `cols` polynomials given their anchor values, slots in rows 0..ell-1
+// of A and random values below
+static void Share(Mat<Fq> &S, const Mat<Fq> &share, Mat<Fq> &A, const Env &env)
+{
+    for (long r = env.ell; r < A.NumRows(); ++r)
+    {
+        for (long j = 0; j < A.NumCols(); ++j)
+        {
+            A[r][j] = random_ZZ_p();
+        }
+    }
+    mul(S, share, A);
+}
+
+void ProbGen(VK_X &vk, Mat<Fq> &sigma, const Env &env, const PK_F &pk, const Vec<Vec<Fq>> &Xs)
+{
+    if (Xs.length() != env.ell)
+        throw std::invalid_argument("Packed ProbGen needs exactly ell inputs");
+    for (int s = 0; s < env.ell; ++s)
+    {
+        if (Xs[s].length() != env.m)
+            throw std::invalid_argument("Length of X must match number of variables in pk");
+    }
+
+    // c_j and b in one matrix: slot s holds X_s and alpha_s
+    Mat<Fq> A, S;
+    A.SetDims(env.shareC.NumCols(), env.m + 1);
+    vk.SetLength(env.ell);
+    for (int s = 0; s < env.ell; ++s)
+    {
+        for (int j = 0; j < env.m; ++j)
+        {
+            A[s][j] = Xs[s][j];
+        }
+        do
+        {
+            A[s][env.m] = random_ZZ_p(); // Ensure alpha is non-zero
+        } while (IsZero(A[s][env.m]));
+        PowerMod(vk[s], env.g, rep(A[s][env.m]), env.fq);
+    }
+    Share(S, env.shareC, A, env);
+
+    // Context hiding: a and e vanish at every slot
+    Mat<Fq> Za, Ze, SA, SE;
+    Za.SetDims(env.sharePhi.NumCols(), 1);
+    Ze.SetDims(env.sharePsi.NumCols(), 1);
+    Share(SA, env.sharePhi, Za, env);
+    Share(SE, env.sharePsi, Ze, env);
+
+    sigma.SetDims(env.k, env.m + 3);
+    for (int i = 0; i < env.k; ++i)
+    {
+        for (int j = 0; j <= env.m; ++j)
+        {
+            sigma[i][j] = S[i][j];
+        }
+        sigma[i][env.m + 1] = SA[i][0];
+        sigma[i][env.m + 2] = SE[i][0];
+    }
+}
+
+void MaskGen(VK_theta &vk, SK_theta &sk, Vec<Fq> &theta, const Env &env, const VK_X &vk_x)
+{
+    vk = vk_x;
+
+    // theta has the degree of phi and holds beta_s at slot s
+    Mat<Fq> B, SB;
+    B.SetDims(env.sharePhi.NumCols(), 1);
+    sk.SetLength(env.ell);
+    for (int s = 0; s < env.ell; ++s)
+    {
+        random(sk[s]);
+        B[s][0] = sk[s];
+    }
+    Share(SB, env.sharePhi, B, env);
+
+    theta.SetLength(env.k);
+    for (int i = 0; i < env.k; ++i)
+    {
+        theta[i] = SB[i][0];
+    }
+}
+
+template <typename Poly>
+void Compute(Vec<Fq> &pi_i, int idx, const Poly &ek_i, const Vec<Fq> &sigma_i, const Fq &theta_i, const Env &env)
+{
+    if (idx < 0 || idx >= env.k)
+        throw std::out_of_range("Index out of range in Compute");
+
+    if (ek_i.varCount() != sigma_i.length() - 3)
+        throw std::invalid_argument("Length of sigma_i must match number of variables in ek_i");
+
+    vector<Fq> eval_points(ek_i.varCount());
+    for (int i = 0; i < env.m; ++i)
+    {
+        eval_points[i] = sigma_i[i];
+    }
+
+    pi_i[0] = ek_i.evaluate(eval_points) + sigma_i[env.m + 1] + theta_i;
+    pi_i[1] = sigma_i[env.m] * pi_i[0] + sigma_i[env.m + 2];
+}
+
+template void Compute(Vec<Fq> &, int, const MultiPoly<Fq> &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Vec<Fq> &, int, const PreparedPoly<Fq> &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Vec<Fq> &, int, const MappedPoly &, const Vec<Fq> &, const Fq &, const Env &);
+template void Compute(Vec<Fq> &, int, const StreamedPoly &, const Vec<Fq> &, const Fq &, const Env &);
+
+bool Verify(const VK_F &vk_f, const VK_X &vk_x, const Mat<Fq> &pi, const Env &env)
+{
+    if (pi.NumRows() != env.k || pi.NumCols() != 2)
+        throw std::invalid_argument("Length of pi must match k in Env");
+    if (vk_x.length() != env.ell)
+        throw std::invalid_argument("vk_x must hold one element per slot");
+
+    // phi and psi at every slot, straight from the shares
+    Mat<Fq> V;
+    mul(V, env.toSlots, pi);
+
+    Vec<ZZ> u, v;
+    u.SetLength(env.ell);
+    v.SetLength(env.ell);
+    for (int s = 0; s < env.ell; ++s)
+    {
+        u[s] = rep(V[s][1]);
+        v[s] = rep(V[s][0]);
+    }
+
+    std::vector<bool> ok;
+    if (!BatchExpCheck(ok, env.g, vk_x, u, v, env.ord, env.fq))
+    {
+        std::cerr << "Verification failed: psi does not match alpha * phi at some slot" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Reconstruct(Vec<Fq> &res, const SK_theta &sk, const Mat<Fq> &pi, const Env &env)
+{
+    if (pi.NumRows() != env.k || sk.length() != env.ell)
+        throw std::invalid_argument("Length of pi must match k in Env");
+
+    res.SetLength(env.ell);
+    Vec<Fq> pi0;
+    pi0.SetLength(env.k);
+    for (int i = 0; i < env.k; ++i)
+    {
+        pi0[i] = pi[i][0];
+    }
+    for (int s = 0; s < env.ell; ++s)
+    {
+        InnerProduct(res[s], env.toSlots[s], pi0);
+        res[s] -= sk[s];
+    }
+}
+}
+}
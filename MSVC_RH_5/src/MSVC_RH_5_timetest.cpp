@@ -17,7 +17,7 @@ Vec<Fq> generateSimpleInput(int size)
     return X;
 }
 
-SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
+SimpleTimingResult runSingleTest(int d, int m, int t, int secpar, const WorkloadSpec &workload)
 {
     SimpleTimingResult result;
     result.success = true;
@@ -33,7 +33,7 @@ SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
         result.initialize_time = timer.elapsed_ms();
 
         // Step 2: Create polynomial
-        MultiPoly<Fq> F = generateFullPoly(m, d, random_ZZ_p());
+        MultiPoly<Fq> F = generateWorkload(workload, m, d);
 
         // Step 3: KeyGen
         timer.start();
@@ -44,7 +44,7 @@ SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
         result.keygen_time = timer.elapsed_ms();
 
         // Step 4: Generate problem instance
-        Vec<Fq> X = generateSimpleInput(env.m);
+        Vec<Fq> X = generateWorkloadInput(workload, env.m);
 
         timer.start();
         Mat<Fq> sigma;
@@ -125,7 +125,7 @@ SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
 }
 
 // Main timing test function
-TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent)
+TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent, const WorkloadSpec &workload)
 {
     if (!silent)
     {
@@ -140,6 +140,7 @@ TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iteration
         std::cout << "  Fq size (secpar): " << secpar << std::endl;
         std::cout << "  Polynomial degree (d): " << d << std::endl;
         std::cout << "  Number of variables (m): " << m << std::endl;
+        std::cout << "  Workload: " << workload.toString() << std::endl;
         std::cout << "  Iterations: " << iterations << std::endl;
         std::cout << std::endl;
     }
@@ -158,7 +159,7 @@ TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iteration
             std::cout << "  Iteration " << (i + 1) << "/" << iterations << "...";
         }
 
-        SimpleTimingResult result = runSingleTest(d, m, t, secpar);
+        SimpleTimingResult result = runSingleTest(d, m, t, secpar, workload);
 
         if (result.success)
         {
@@ -226,4 +227,391 @@ TestResultData MSVC_RH_5_TIMETEST(int d, int m, int t, int secpar, int iteration
     }
     return testResult;
 }
-}
\ No newline at end of file
+
+SimpleTimingResult runSinglePackedTest(int d, int m, int t, int ell, int secpar)
+{
+    SimpleTimingResult result;
+    result.success = true;
+
+    SimpleTimer timer;
+
+    try
+    {
+        // Step 1: Initialize
+        timer.start();
+        Packed::Env env;
+        Packed::Initialize(env, t, ell, secpar);
+        result.initialize_time = timer.elapsed_ms();
+
+        // Step 2: Create polynomial
+        MultiPoly<Fq> F = generateFullPoly(m, d, random_ZZ_p());
+
+        // Step 3: KeyGen
+        timer.start();
+        Packed::PK_F pk;
+        Packed::VK_F vk_f;
+        Packed::EK_F ek;
+        Packed::KeyGen(pk, vk_f, ek, env, F);
+        result.keygen_time = timer.elapsed_ms();
+
+        // Step 4: Generate problem instance, one input per slot
+        Vec<Vec<Fq>> Xs;
+        Xs.SetLength(ell);
+        for (int s = 0; s < ell; ++s)
+        {
+            Xs[s] = generateSimpleInput(env.m);
+            for (int j = 0; j < env.m; ++j)
+            {
+                Xs[s][j] += s;
+            }
+        }
+
+        timer.start();
+        Mat<Fq> sigma;
+        Packed::VK_X vk_x;
+        Packed::ProbGen(vk_x, sigma, env, pk, Xs);
+        result.probgen_time = timer.elapsed_ms();
+
+        // Step 5: Generate masks
+        timer.start();
+        Vec<Fq> theta;
+        Packed::VK_theta vk_theta;
+        Packed::SK_theta sk_theta;
+        Packed::MaskGen(vk_theta, sk_theta, theta, env, vk_x);
+        result.maskgen_time = timer.elapsed_ms();
+
+        // Step 6: Compute proofs
+        Mat<Fq> pi;
+        pi.SetDims(env.k, 2);
+
+        double max_compute_time = 0.0;
+        for (int i = 0; i < env.k; ++i)
+        {
+            timer.start();
+            Packed::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+            double single_compute_time = timer.elapsed_ms();
+
+            if (single_compute_time > max_compute_time)
+            {
+                max_compute_time = single_compute_time;
+            }
+        }
+        result.compute_time = max_compute_time;
+
+        // Step 7: Verify
+        timer.start();
+        bool verified = Packed::Verify(vk_f, vk_x, pi, env);
+        result.verify_time = timer.elapsed_ms();
+
+        // Step 8: Reconstruct results
+        timer.start();
+        Vec<Fq> verification_results;
+        Packed::Reconstruct(verification_results, sk_theta, pi, env);
+        result.reconstruct_time = timer.elapsed_ms();
+
+        // Step 9: Direct compute for comparison
+        timer.start();
+        bool matches = true;
+        std::vector<Fq> X_vec(env.m);
+        for (int s = 0; s < ell; ++s)
+        {
+            for (int i = 0; i < env.m; ++i)
+            {
+                X_vec[i] = Xs[s][i];
+            }
+            if (F.evaluate(X_vec) != verification_results[s])
+                matches = false;
+        }
+        result.direct_compute_time = timer.elapsed_ms();
+
+        // Report everything per input
+        result.initialize_time /= ell;
+        result.keygen_time /= ell;
+        result.probgen_time /= ell;
+        result.maskgen_time /= ell;
+        result.compute_time /= ell;
+        result.verify_time /= ell;
+        result.reconstruct_time /= ell;
+        result.direct_compute_time /= ell;
+
+        result.total_time = result.initialize_time + result.keygen_time +
+                            result.probgen_time + result.maskgen_time + result.compute_time +
+                            result.verify_time + result.reconstruct_time;
+
+        if (!verified)
+        {
+            result.success = false;
+            std::cout << "Verification failed!" << std::endl;
+        }
+
+        if (verified && !matches)
+        {
+            std::cout << "Warning: Protocol result doesn't match direct computation!" << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        result.success = false;
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+
+    return result;
+}
+
+TestResultData MSVC_RH_5_PACKED_TIMETEST(int d, int m, int t, int ell, int secpar, int iterations, bool silent)
+{
+    if (!silent)
+    {
+        std::cout << "=========================================" << std::endl;
+        std::cout << "  MSVC_RH_5 Packed Simple Timing Test   " << std::endl;
+        std::cout << "=========================================" << std::endl;
+        std::cout << std::endl;
+
+        std::cout << "Configuration:" << std::endl;
+        std::cout << "  Privacy (t): " << t << std::endl;
+        std::cout << "  Slots (ell): " << ell << std::endl;
+        std::cout << "  Fq size (secpar): " << secpar << std::endl;
+        std::cout << "  Polynomial degree (d): " << d << std::endl;
+        std::cout << "  Number of variables (m): " << m << std::endl;
+        std::cout << "  Iterations: " << iterations << std::endl;
+        std::cout << std::endl;
+        std::cout << "Running " << iterations << " iterations..." << std::endl;
+    }
+
+    std::vector<SimpleTimingResult> results;
+    for (int i = 0; i < iterations; ++i)
+    {
+        if (!silent)
+        {
+            std::cout << "  Iteration " << (i + 1) << "/" << iterations << "...";
+        }
+
+        SimpleTimingResult result = runSinglePackedTest(d, m, t, ell, secpar);
+
+        if (result.success)
+        {
+            results.push_back(result);
+            if (!silent)
+            {
+                std::cout << " OK (" << std::fixed << std::setprecision(2)
+                          << result.total_time << " ms per input)" << std::endl;
+            }
+        }
+        else if (!silent)
+        {
+            std::cout << " FAILED" << std::endl;
+        }
+    }
+
+    TestResultData testResult = calculateAverageWithoutExtremes(results);
+
+    if (!silent)
+    {
+        std::cout << std::endl;
+        std::cout << "Successful runs: " << testResult.successful_runs << "/" << iterations << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Average Times per input (ms):" << std::endl;
+        std::cout << "  Initialize:      " << std::setw(10) << testResult.initialize_time << std::endl;
+        std::cout << "  KeyGen:          " << std::setw(10) << testResult.keygen_time << std::endl;
+        std::cout << "  ProbGen:         " << std::setw(10) << testResult.probgen_time << std::endl;
+        std::cout << "  MaskGen:         " << std::setw(10) << testResult.maskgen_time << std::endl;
+        std::cout << "  Compute:         " << std::setw(10) << testResult.compute_time << std::endl;
+        std::cout << "  Verify:          " << std::setw(10) << testResult.verify_time << std::endl;
+        std::cout << "  Reconstruct:     " << std::setw(10) << testResult.reconstruct_time << std::endl;
+        std::cout << "  DirectCompute:   " << std::setw(10) << testResult.direct_compute_time << std::endl;
+        std::cout << "  -----------" << std::endl;
+        std::cout << "  Total (Protocol):" << std::setw(10) << testResult.total_time << std::endl;
+        std::cout << std::endl;
+    }
+    return testResult;
+}
+
+SimpleTimingResult runSingleFirstKTest(int d, int m, int t, int spare, const std::vector<LatencyModel> &latency, int secpar, uint64_t seed, double &no_spare_ms)
+{
+    SimpleTimingResult result;
+    result.success = true;
+
+    SimpleTimer timer;
+
+    try
+    {
+        // Step 1: Initialize
+        timer.start();
+        Env env;
+        Initialize(env, t, secpar);
+        env.n = (d + 1) * t + 1 + spare; // k + spare for the full degree-d F
+        result.initialize_time = timer.elapsed_ms();
+
+        // Step 2: Create polynomial
+        MultiPoly<Fq> F = generateFullPoly(m, d, random_ZZ_p());
+
+        // Step 3: KeyGen
+        timer.start();
+        PK_F pk;
+        VK_F vk_f;
+        EK_F ek;
+        KeyGen(pk, vk_f, ek, env, F);
+        result.keygen_time = timer.elapsed_ms();
+
+        // Step 4: Generate problem instance
+        Vec<Fq> X = generateSimpleInput(env.m);
+
+        timer.start();
+        Mat<Fq> sigma;
+        VK_X vk_x;
+        ProbGen(vk_x, sigma, env, pk, X);
+        result.probgen_time = timer.elapsed_ms();
+
+        // Step 5: Generate masks
+        timer.start();
+        Vec<Fq> theta;
+        VK_theta vk_theta;
+        SK_theta sk_theta;
+        MaskGen(vk_theta, sk_theta, theta, env, vk_x);
+        result.maskgen_time = timer.elapsed_ms();
+
+        // Step 6: Compute proofs on all n servers, then simulate their arrival
+        Mat<Fq> pi;
+        pi.SetDims(env.n, 2);
+        std::vector<double> compute_ms(env.n), arrival;
+        for (int i = 0; i < env.n; ++i)
+        {
+            timer.start();
+            Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+            compute_ms[i] = timer.elapsed_ms();
+        }
+        StragglerSim sim(latency, env.n, seed);
+        sim.arrivals(arrival, compute_ms);
+
+        Vec<long> idx;
+        result.compute_time = StragglerSim::firstK(idx, arrival, env.k);
+        no_spare_ms = *std::max_element(arrival.begin(), arrival.begin() + env.k);
+
+        Mat<Fq> pi_k;
+        pi_k.SetDims(env.k, 2);
+        for (int r = 0; r < env.k; ++r)
+        {
+            pi_k[r] = pi[idx[r]];
+        }
+
+        // Step 7: Verify
+        timer.start();
+        bool verified = VerifyAt(vk_f, vk_x, pi_k, idx, env);
+        result.verify_time = timer.elapsed_ms();
+
+        // Step 8: Reconstruct result
+        timer.start();
+        Fq verification_result;
+        ReconstructAt(verification_result, sk_theta, pi_k, idx, env);
+        result.reconstruct_time = timer.elapsed_ms();
+
+        // Step 9: Direct compute for comparison
+        timer.start();
+        std::vector<Fq> X_vec(env.m);
+        for (int i = 0; i < env.m; ++i)
+        {
+            X_vec[i] = X[i];
+        }
+        Fq direct_result = F.evaluate(X_vec);
+        result.direct_compute_time = timer.elapsed_ms();
+
+        result.total_time = result.initialize_time + result.keygen_time +
+                            result.probgen_time + result.maskgen_time + result.compute_time +
+                            result.verify_time + result.reconstruct_time;
+
+        if (!verified)
+        {
+            result.success = false;
+            std::cout << "Verification failed!" << std::endl;
+        }
+
+        if (verified && direct_result != verification_result)
+        {
+            std::cout << "Warning: Protocol result doesn't match direct computation!" << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        result.success = false;
+        std::cout << "Exception: " << e.what() << std::endl;
+    }
+
+    return result;
+}
+
+TestResultData MSVC_RH_5_FIRSTK_TIMETEST(int d, int m, int t, int spare, const std::vector<LatencyModel> &latency, int secpar, int iterations, bool silent)
+{
+    if (!silent)
+    {
+        std::cout << "=========================================" << std::endl;
+        std::cout << "  MSVC_RH_5 First-k Straggler Test      " << std::endl;
+        std::cout << "=========================================" << std::endl;
+        std::cout << std::endl;
+
+        std::cout << "Configuration:" << std::endl;
+        std::cout << "  Privacy (t): " << t << std::endl;
+        std::cout << "  Spare servers: " << spare << std::endl;
+        std::cout << "  Latency model:";
+        for (const auto &model : latency)
+        {
+            std::cout << " " << model.toString();
+        }
+        std::cout << std::endl;
+        std::cout << "  Fq size (secpar): " << secpar << std::endl;
+        std::cout << "  Polynomial degree (d): " << d << std::endl;
+        std::cout << "  Number of variables (m): " << m << std::endl;
+        std::cout << "  Iterations: " << iterations << std::endl;
+        std::cout << std::endl;
+        std::cout << "Running " << iterations << " iterations..." << std::endl;
+    }
+
+    std::vector<SimpleTimingResult> results;
+    std::vector<double> first_k, no_spare;
+    for (int i = 0; i < iterations; ++i)
+    {
+        if (!silent)
+        {
+            std::cout << "  Iteration " << (i + 1) << "/" << iterations << "...";
+        }
+
+        double wait_all = 0;
+        SimpleTimingResult result = runSingleFirstKTest(d, m, t, spare, latency, secpar, i + 1, wait_all);
+
+        if (result.success)
+        {
+            results.push_back(result);
+            first_k.push_back(result.compute_time);
+            no_spare.push_back(wait_all);
+            if (!silent)
+            {
+                std::cout << " OK (" << std::fixed << std::setprecision(2)
+                          << result.total_time << " ms)" << std::endl;
+            }
+        }
+        else if (!silent)
+        {
+            std::cout << " FAILED" << std::endl;
+        }
+    }
+
+    TestResultData testResult = calculateAverageWithoutExtremes(results);
+
+    if (!silent)
+    {
+        std::cout << std::endl;
+        std::cout << "Successful runs: " << testResult.successful_runs << "/" << iterations << std::endl;
+    }
+
+    // The tail comparison is the point of this test, so it is printed even when silent
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Wait for k responses (ms):      p50        p95        p99" << std::endl;
+    std::cout << "  First k of k+spare: " << std::setw(10) << StragglerSim::percentile(first_k, 50)
+              << " " << std::setw(10) << StragglerSim::percentile(first_k, 95)
+              << " " << std::setw(10) << StragglerSim::percentile(first_k, 99) << std::endl;
+    std::cout << "  Servers 0..k-1:     " << std::setw(10) << StragglerSim::percentile(no_spare, 50)
+              << " " << std::setw(10) << StragglerSim::percentile(no_spare, 95)
+              << " " << std::setw(10) << StragglerSim::percentile(no_spare, 99) << std::endl;
+    std::cout << std::endl;
+    return testResult;
+}
+}
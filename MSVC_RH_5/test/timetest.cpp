@@ -1,11 +1,13 @@
 #include "MSVC_RH_5_timetest.h"
-int main()
+int main(int argc, char *argv[])
 {
     int d = 2;            // Polynomial degree
     size_t m = 100;       // Number of variables
     int t = 1;            // Number of variables
     int secpar = 128;     // Security parameter
     int iterations = 100; // Number of iterations for averaging
-    RH5::MSVC_RH_5_TIMETEST(d, m, t, secpar, iterations);
+    // Optional workload spec, e.g. sparse:5000:0.5:uniform:random:7
+    WorkloadSpec workload = argc > 1 ? WorkloadSpec::parse(argv[1]) : WorkloadSpec();
+    RH5::MSVC_RH_5_TIMETEST(d, m, t, secpar, iterations, false, workload);
     return 0;
 }
\ No newline at end of file
@@ -54,11 +54,11 @@ namespace SP4
         printEnv(env);
 
         std::cout << "Key generation completed." << std::endl;
-        std::cout << "Public Key (pk) size: " << pk.length() << std::endl;
-        for (int i = 0; i < pk.length(); ++i)
+        std::cout << "Public Key (pk) size: " << pk.ell.length() << std::endl;
+        for (int i = 0; i < pk.ell.length(); ++i)
         {
             std::cout << "Public Key Polynomial " << i << " = ";
-            std::cout << pk[i].toString({"u"}) << std::endl;
+            std::cout << pk.ell.poly(i).toString({"u"}) << std::endl;
         }
         std::cout << std::endl;
 
@@ -66,9 +66,9 @@ namespace SP4
         for (int i = 0; i < vk_f.ell.length(); ++i)
         {
             std::cout << "vk_f.ell[" << i << "] = ";
-            std::cout << vk_f.ell[i].toString({"u"}) << std::endl;
+            std::cout << vk_f.ell.poly(i).toString({"u"}) << std::endl;
         }
-        std::cout << "vk_f.f = " << vk_f.f.toString({"u"}) << std::endl
+        std::cout << "vk_f.f = " << vk_f.f << std::endl
                   << std::endl;
 
         // Step 4: Generate problem instance
@@ -87,7 +87,7 @@ namespace SP4
         ProbGen(vk_x, sigma, env, pk, X);
 
         std::cout << "ProbGen completed." << std::endl;
-        std::cout << "vk_x.a = " << vk_x.a << std::endl;
+        std::cout << "vk_x.gfa = " << vk_x.gfa << std::endl;
         std::cout << "vk_x.alpha = " << vk_x.alpha << std::endl;
         printMatrix(sigma, "sigma Matrix");
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "MSVC_SP_5.h"
+#include "Workload.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -7,6 +8,6 @@
 namespace SP5
 {
     // Function to run simple timing tests for MSVC_SP_5
-    TestResultData MSVC_SP_5_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false);
-    SimpleTimingResult runSingleTest(int d, int m, int t, int secpar);
+    TestResultData MSVC_SP_5_TIMETEST(int d, int m, int t, int secpar, int iterations = 10, bool silent = false, const WorkloadSpec &workload = WorkloadSpec());
+    SimpleTimingResult runSingleTest(int d, int m, int t, int secpar, const WorkloadSpec &workload = WorkloadSpec());
 }
\ No newline at end of file
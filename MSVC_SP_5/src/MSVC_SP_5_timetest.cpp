@@ -5,7 +5,7 @@
 #include <vector>
 namespace SP5{
 
-SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
+SimpleTimingResult runSingleTest(int d, int m, int t, int secpar, const WorkloadSpec &workload)
 {
     SimpleTimingResult result;
     result.success = true;
@@ -23,7 +23,7 @@ SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
         result.initialize_time = timer.elapsed_ms();
 
         // Step 2: Create polynomial
-        MultiPoly<Fq> F = generateFullPoly(m, d, random_ZZ_p());
+        MultiPoly<Fq> F = generateWorkload(workload, m, d);
 
         // Step 3: KeyGen
         timer.start();
@@ -34,7 +34,7 @@ SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
         result.keygen_time = timer.elapsed_ms();
 
         // Step 4: Generate problem instance
-        Vec<Fq> X = generateSimpleInput(env.m);
+        Vec<Fq> X = generateWorkloadInput(workload, env.m);
 
         timer.start();
         Mat<Fq> sigma;
@@ -121,7 +121,7 @@ SimpleTimingResult runSingleTest(int d, int m, int t, int secpar)
 }
 
 // Main timing test function
-TestResultData MSVC_SP_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent)
+TestResultData MSVC_SP_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent, const WorkloadSpec &workload)
 {
     if (!silent)
     {
@@ -136,6 +136,7 @@ TestResultData MSVC_SP_5_TIMETEST(int d, int m, int t, int secpar, int iteration
         std::cout << "  Fq size (secpar): " << secpar << std::endl;
         std::cout << "  Polynomial degree (d): " << d << std::endl;
         std::cout << "  Number of variables (m): " << m << std::endl;
+        std::cout << "  Workload: " << workload.toString() << std::endl;
         std::cout << "  Iterations: " << iterations << std::endl;
         std::cout << std::endl;
     }
@@ -155,7 +156,7 @@ TestResultData MSVC_SP_5_TIMETEST(int d, int m, int t, int secpar, int iteration
             std::cout << "  Iteration " << (i + 1) << "/" << iterations << "...";
         }
 
-        SimpleTimingResult result = runSingleTest(d, m, t, secpar);
+        SimpleTimingResult result = runSingleTest(d, m, t, secpar, workload);
 
         if (result.success)
         {
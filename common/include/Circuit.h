@@ -0,0 +1,164 @@
+// Circuit.h
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+// Arithmetic circuit (straight-line program) for F, for functions that are
+// small as circuits but large as monomial lists, e.g. products of sums.
+// Wires 0..m-1 are the inputs; every gate appends one wire computed from
+// earlier wires, so evaluation is a single forward pass over the gate list.
+// The declared degree bound is maxDegree(), which KeyGen uses for d; gates
+// whose formal degree would exceed it are rejected when they are added.
+// Evaluation costs one field operation per gate, independent of how many
+// monomials F expands to.
+
+template <typename Coeff>
+class Circuit
+{
+public:
+    using Wire = std::uint32_t;
+
+    Circuit() : varCount_(0), maxDegree_(0), output_(0) {}
+
+    // m inputs and no gates; the output starts as input 0
+    Circuit(size_t m, int d) : varCount_(m), maxDegree_(d), output_(0), degree_(m, 1)
+    {
+        if (m == 0)
+            throw std::invalid_argument("Number of variables m must be >0");
+        if (d < 1)
+            throw std::invalid_argument("Degree bound d must be >0");
+        if (m > std::numeric_limits<Wire>::max())
+            throw std::out_of_range("Too many variables for Circuit");
+    }
+
+    size_t varCount() const { return varCount_; }
+    int maxDegree() const { return maxDegree_; }
+    size_t gateCount() const { return op_.size(); }
+    size_t wireCount() const { return degree_.size(); }
+
+    // Formal degree of wire w
+    int degree(Wire w) const { return degree_.at(w); }
+
+    Wire input(size_t i) const
+    {
+        if (i >= varCount_)
+            throw std::out_of_range("Variable index out of range");
+        return static_cast<Wire>(i);
+    }
+
+    Wire constant(const Coeff &c)
+    {
+        consts_.push_back(c);
+        return push(Const, static_cast<Wire>(consts_.size() - 1), 0, 0);
+    }
+
+    Wire add(Wire a, Wire b)
+    {
+        return push(Add, a, b, std::max(degree(a), degree(b)));
+    }
+
+    Wire mul(Wire a, Wire b)
+    {
+        return push(Mul, a, b, degree(a) + degree(b));
+    }
+
+    // a_0 + ... + a_{n-1} and a_0 * ... * a_{n-1} as chains of binary gates
+    Wire sum(const std::vector<Wire> &a)
+    {
+        if (a.empty())
+            return constant(Coeff(0));
+        Wire s = a[0];
+        for (size_t i = 1; i < a.size(); i++)
+            s = add(s, a[i]);
+        return s;
+    }
+
+    Wire product(const std::vector<Wire> &a)
+    {
+        if (a.empty())
+            return constant(Coeff(1));
+        Wire p = a[0];
+        for (size_t i = 1; i < a.size(); i++)
+            p = mul(p, a[i]);
+        return p;
+    }
+
+    // Mark w as the value of F
+    void setOutput(Wire w)
+    {
+        degree(w);
+        output_ = w;
+    }
+    Wire output() const { return output_; }
+
+    Coeff evaluate(const std::vector<Coeff> &pts) const
+    {
+        if (pts.size() != varCount_)
+            throw std::invalid_argument("Point must have one value per variable");
+        std::vector<Coeff> v(degree_.size());
+        std::copy(pts.begin(), pts.end(), v.begin());
+        size_t w = varCount_;
+        for (size_t g = 0; g < op_.size(); g++, w++)
+        {
+            switch (op_[g])
+            {
+            case Const:
+                v[w] = consts_[a_[g]];
+                break;
+            case Add:
+                v[w] = v[a_[g]] + v[b_[g]];
+                break;
+            case Mul:
+                v[w] = v[a_[g]] * v[b_[g]];
+                break;
+            }
+        }
+        return v[output_];
+    }
+
+private:
+    enum Op : std::uint8_t { Const, Add, Mul };
+
+    Wire push(Op op, Wire a, Wire b, int deg)
+    {
+        if (op != Const && (a >= degree_.size() || b >= degree_.size()))
+            throw std::out_of_range("Gate input is not an existing wire");
+        if (deg > maxDegree_)
+            throw std::invalid_argument("Gate degree exceeds the declared bound d");
+        if (degree_.size() >= std::numeric_limits<Wire>::max())
+            throw std::out_of_range("Too many gates for Circuit");
+        op_.push_back(op);
+        a_.push_back(a);
+        b_.push_back(b);
+        degree_.push_back(deg);
+        return static_cast<Wire>(degree_.size() - 1);
+    }
+
+    size_t varCount_;
+    int maxDegree_;
+    Wire output_;
+    std::vector<int> degree_;
+    std::vector<Op> op_;
+    std::vector<Wire> a_;
+    std::vector<Wire> b_;
+    std::vector<Coeff> consts_;
+};
+
+// prod_{j<d} (c + x_0 + ... + x_{m-1}), which has C(m+d, d) monomials but
+// only m + d gates as a circuit
+template <typename Coeff>
+Circuit<Coeff> generateProductOfSums(size_t m, int d, const Coeff &c = Coeff(1))
+{
+    Circuit<Coeff> C(m, d);
+    std::vector<typename Circuit<Coeff>::Wire> x(m + 1);
+    for (size_t i = 0; i < m; i++)
+        x[i] = C.input(i);
+    x[m] = C.constant(c);
+    auto s = C.sum(x);
+    C.setOutput(C.product(std::vector<typename Circuit<Coeff>::Wire>(d, s)));
+    return C;
+}
@@ -0,0 +1,110 @@
+// EvalKey.h
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Shared evaluation key.
+// Every server evaluates the same function, so KeyGen keeps a single copy of F
+// behind a reference-counted handle and hands out k lightweight views of it.
+// Copying an EvalKey (or taking a view) never copies the polynomial; only
+// modify() does, and only while the polynomial is still shared.
+//
+// The interface mirrors the Vec<MultiPoly<Fq>> it replaces:
+//   ek.length(), ek[i], ek.kill()
+
+template <typename Poly>
+class EvalKey
+{
+public:
+    using Handle = std::shared_ptr<const Poly>;
+
+    EvalKey() : owned_(nullptr), count_(0) {}
+    EvalKey(Handle F, long k) : poly_(std::move(F)), owned_(nullptr), count_(k)
+    {
+        if (!poly_ && k > 0)
+            throw std::invalid_argument("EvalKey requires a polynomial when k > 0");
+        if (k < 0)
+            throw std::invalid_argument("EvalKey server count must be >= 0");
+    }
+
+    // Build a key for k servers; F is copied exactly once.
+    static EvalKey share(const Poly &F, long k)
+    {
+        return adopt(std::make_shared<Poly>(F), k);
+    }
+
+    // Build a key for k servers, taking ownership of an already-built F
+    static EvalKey share(Poly &&F, long k)
+    {
+        return adopt(std::make_shared<Poly>(std::move(F)), k);
+    }
+
+    long length() const { return count_; }
+
+    // View of server i's key; all views alias the same polynomial
+    const Poly &operator[](long i) const
+    {
+        check(i);
+        return *poly_;
+    }
+
+    // Owning view for server i, e.g. to hand to a worker thread
+    Handle view(long i) const
+    {
+        check(i);
+        return poly_;
+    }
+
+    // Number of EvalKey objects and views currently sharing the polynomial
+    long useCount() const { return poly_.use_count(); }
+
+    // Apply fn(Poly &) to the polynomial, for key updates. The change is made
+    // in place when this key is the only owner; otherwise the polynomial is
+    // copied first, so other keys and outstanding views keep the old version.
+    // References from operator[] are not counted: a server still evaluating
+    // through ek[i] must not overlap a modify(). Servers that run concurrently
+    // with updates should hold view(i), which pins the version they started on.
+    template <typename Fn>
+    void modify(Fn &&fn)
+    {
+        if (!poly_)
+            throw std::logic_error("Cannot modify an empty evaluation key");
+        if (!owned_ || poly_.use_count() > 1)
+        {
+            auto copy = std::make_shared<Poly>(*poly_);
+            owned_ = copy.get();
+            poly_ = std::move(copy);
+        }
+        fn(*owned_);
+    }
+
+    void kill()
+    {
+        poly_.reset();
+        owned_ = nullptr;
+        count_ = 0;
+    }
+
+private:
+    static EvalKey adopt(std::shared_ptr<Poly> F, long k)
+    {
+        Poly *p = F.get();
+        EvalKey ek(std::move(F), k);
+        ek.owned_ = p;
+        return ek;
+    }
+
+    void check(long i) const
+    {
+        if (i < 0 || i >= count_)
+            throw std::out_of_range("Evaluation key index " + std::to_string(i) +
+                                    " out of range [0, " + std::to_string(count_) + ")");
+    }
+
+    Handle poly_;
+    Poly *owned_; // non-const alias of poly_ when this key allocated it
+    long count_;
+};
@@ -0,0 +1,165 @@
+// IncrementalEvaluator.h
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include "MultiPoly.h"
+
+// Server-side evaluator for a fixed F at a point that changes a few
+// coordinates at a time.
+//
+// The terms of F are stored flat, each as its coefficient and the sparse
+// list of (variable, exponent) pairs it contains, and a per-variable index
+// lists the terms that contain each variable. After reset() has evaluated
+// F once, update() changes some coordinates and corrects the cached value
+// using only the terms that touch them: every such term is evaluated at
+// the old and the new point, so an update costs O(touched terms * degree)
+// regardless of |F|.
+
+template <typename Coeff>
+class IncrementalEvaluator
+{
+public:
+    using Index = std::uint32_t;
+
+    IncrementalEvaluator() : varCount_(0) {}
+
+    explicit IncrementalEvaluator(const MultiPoly<Coeff> &F)
+        : varCount_(F.varCount())
+    {
+        const size_t limit = std::numeric_limits<Index>::max();
+        if (F.termCount() > limit || varCount_ > limit)
+            throw std::out_of_range("Too many terms for IncrementalEvaluator");
+
+        termStart_.reserve(F.termCount() + 1);
+        coeff_.reserve(F.termCount());
+        std::vector<Index> count(varCount_ + 1, 0);
+        for (const auto &[e, c] : F.terms())
+        {
+            checkOccurrences();
+            termStart_.push_back(static_cast<Index>(var_.size()));
+            coeff_.push_back(c);
+            for (size_t v = 0; v < e.size(); v++)
+            {
+                if (e[v] == 0)
+                    continue;
+                var_.push_back(static_cast<Index>(v));
+                exp_.push_back(e[v]);
+                count[v + 1]++;
+            }
+        }
+        checkOccurrences();
+        termStart_.push_back(static_cast<Index>(var_.size()));
+
+        // Per-variable term index in CSR form
+        varStart_.assign(count.begin(), count.end());
+        for (size_t v = 0; v < varCount_; v++)
+            varStart_[v + 1] += varStart_[v];
+        varTerms_.resize(var_.size());
+        std::vector<Index> fill(varStart_.begin(), varStart_.end() - 1);
+        for (size_t t = 0; t + 1 < termStart_.size(); t++)
+            for (Index p = termStart_[t]; p < termStart_[t + 1]; p++)
+                varTerms_[fill[var_[p]]++] = static_cast<Index>(t);
+
+        stamp_.assign(coeff_.size(), 0);
+        epoch_ = 0;
+    }
+
+    size_t varCount() const { return varCount_; }
+    size_t termCount() const { return coeff_.size(); }
+
+    // Number of terms that contain variable v
+    size_t termsWith(size_t v) const { return varStart_[v + 1] - varStart_[v]; }
+
+    // Evaluate F from scratch at pts and remember the point
+    const Coeff &reset(const std::vector<Coeff> &pts)
+    {
+        if (pts.size() != varCount_)
+            throw std::invalid_argument("Point must have one value per variable");
+        pts_ = pts;
+        value_ = Coeff(0);
+        for (size_t t = 0; t < coeff_.size(); t++)
+            value_ += term(t);
+        return value_;
+    }
+
+    // Set pts[vars[i]] = vals[i] and correct the value through the touched terms
+    const Coeff &update(const std::vector<size_t> &vars, const std::vector<Coeff> &vals)
+    {
+        if (vars.size() != vals.size())
+            throw std::invalid_argument("update needs one value per variable");
+        if (pts_.size() != varCount_)
+            throw std::logic_error("update called before reset");
+
+        // Collect each touched term once
+        if (++epoch_ == 0)
+        {
+            std::fill(stamp_.begin(), stamp_.end(), 0);
+            epoch_ = 1;
+        }
+        touched_.clear();
+        for (size_t v : vars)
+        {
+            if (v >= varCount_)
+                throw std::out_of_range("Variable index out of range");
+            for (Index p = varStart_[v]; p < varStart_[v + 1]; p++)
+            {
+                Index t = varTerms_[p];
+                if (stamp_[t] != epoch_)
+                {
+                    stamp_[t] = epoch_;
+                    touched_.push_back(t);
+                }
+            }
+        }
+
+        for (Index t : touched_)
+            value_ -= term(t);
+        for (size_t i = 0; i < vars.size(); i++)
+            pts_[vars[i]] = vals[i];
+        for (Index t : touched_)
+            value_ += term(t);
+        return value_;
+    }
+
+    const Coeff &value() const { return value_; }
+    const std::vector<Coeff> &point() const { return pts_; }
+
+private:
+    // Offsets into var_ are stored as Index too, so the total number of
+    // variable occurrences over all terms must fit as well
+    void checkOccurrences() const
+    {
+        if (var_.size() > std::numeric_limits<Index>::max())
+            throw std::out_of_range("Too many variable occurrences for IncrementalEvaluator");
+    }
+
+    // coeff * prod x_v^e_v for term t at the current point
+    Coeff term(size_t t) const
+    {
+        Coeff r = coeff_[t];
+        for (Index p = termStart_[t]; p < termStart_[t + 1]; p++)
+        {
+            const Coeff &x = pts_[var_[p]];
+            for (int e = 0; e < exp_[p]; e++)
+                r *= x;
+        }
+        return r;
+    }
+
+    size_t varCount_;
+    std::vector<Coeff> coeff_;
+    std::vector<Index> termStart_;
+    std::vector<Index> var_;
+    std::vector<int> exp_;
+    std::vector<Index> varStart_;
+    std::vector<Index> varTerms_;
+
+    std::vector<Coeff> pts_;
+    Coeff value_;
+    std::vector<std::uint32_t> stamp_;
+    std::uint32_t epoch_ = 0;
+    std::vector<Index> touched_;
+};
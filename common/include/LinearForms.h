@@ -0,0 +1,117 @@
+// LinearForms.h
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "MultiPoly.h"
+
+// r affine forms F_j(x) = c_j + sum_i W_ji x_i over m variables, the d = 1
+// evaluation key for many outputs at once (e.g. a linear layer). W is dense
+// and row-major, so evaluating every output is one matrix-vector product.
+
+template <typename Coeff>
+class LinearForms
+{
+public:
+    LinearForms() : rows_(0), cols_(0) {}
+
+    // r zero forms in m variables
+    LinearForms(size_t r, size_t m)
+        : rows_(r), cols_(m), offset_(r, Coeff(0)), weight_(r * m, Coeff(0))
+    {
+        if (r == 0 || m == 0)
+            throw std::invalid_argument("LinearForms needs at least one form and one variable");
+    }
+
+    // The forms F_1..F_r, each of degree at most 1 in the same m variables
+    explicit LinearForms(const std::vector<MultiPoly<Coeff>> &F)
+        : LinearForms(F.size(), F.empty() ? 0 : F[0].varCount())
+    {
+        for (size_t j = 0; j < rows_; j++)
+            setRow(j, F[j]);
+    }
+
+    size_t varCount() const { return cols_; }
+    size_t outputCount() const { return rows_; }
+    int maxDegree() const { return 1; }
+
+    Coeff &offset(size_t j) { return offset_.at(j); }
+    const Coeff &offset(size_t j) const { return offset_.at(j); }
+    Coeff &weight(size_t j, size_t i) { return weight_.at(index(j, i)); }
+    const Coeff &weight(size_t j, size_t i) const { return weight_.at(index(j, i)); }
+
+    // Replace form j by F; form j is unchanged if F is rejected
+    void setRow(size_t j, const MultiPoly<Coeff> &F)
+    {
+        if (j >= rows_)
+            throw std::out_of_range("Form index out of range");
+        if (F.varCount() != cols_)
+            throw std::invalid_argument("Every form must have the same variables");
+        std::vector<Coeff> w(cols_, Coeff(0));
+        Coeff c0(0);
+        for (const auto &[e, c] : F.terms())
+        {
+            auto nz = std::find_if(e.begin(), e.end(), [](int x) { return x != 0; });
+            if (nz == e.end())
+            {
+                c0 += c;
+                continue;
+            }
+            if (*nz != 1 || std::find_if(nz + 1, e.end(), [](int x) { return x != 0; }) != e.end())
+                throw std::invalid_argument("LinearForms needs deg F <= 1");
+            w[nz - e.begin()] += c;
+        }
+        std::copy(w.begin(), w.end(), weight_.begin() + j * cols_);
+        offset_[j] = c0;
+    }
+
+    // out[j] = F_j(pts) for every form. For ZZ_p each row is accumulated as
+    // ZZ and reduced once, instead of after every product.
+    void evaluate(std::vector<Coeff> &out, const std::vector<Coeff> &pts) const
+    {
+        if (pts.size() != cols_)
+            throw std::invalid_argument("Point must have one value per variable");
+        out.resize(rows_);
+        const Coeff *x = pts.data();
+        const Coeff *w = weight_.data();
+        for (size_t j = 0; j < rows_; j++, w += cols_)
+        {
+            if constexpr (std::is_same_v<Coeff, NTL::ZZ_p>)
+            {
+                NTL::ZZ s = rep(offset_[j]);
+                for (size_t i = 0; i < cols_; i++)
+                    s += rep(w[i]) * rep(x[i]);
+                conv(out[j], s);
+            }
+            else
+            {
+                Coeff s = offset_[j];
+                for (size_t i = 0; i < cols_; i++)
+                    s += w[i] * x[i];
+                out[j] = s;
+            }
+        }
+    }
+
+private:
+    size_t index(size_t j, size_t i) const
+    {
+        if (j >= rows_ || i >= cols_)
+            throw std::out_of_range("LinearForms index out of range");
+        return j * cols_ + i;
+    }
+
+    size_t rows_;
+    size_t cols_;
+    std::vector<Coeff> offset_;
+    std::vector<Coeff> weight_;
+};
+
+// All outputs of a vector-valued F at pts, for ComputeMulti
+template <typename Coeff>
+void EvaluateAll(std::vector<Coeff> &out, const LinearForms<Coeff> &F, const std::vector<Coeff> &pts)
+{
+    F.evaluate(out, pts);
+}
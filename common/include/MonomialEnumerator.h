@@ -0,0 +1,96 @@
+// MonomialEnumerator.h
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+// Streams the exponent vectors of all monomials of total degree <= d in m
+// variables, in the lexicographic order of MultiPoly's term map, without
+// building the polynomial. One exponent vector is reused and each step is
+// O(1): with sum < d the last exponent is incremented, otherwise the last
+// nonzero exponent is cleared and carried into its left neighbour.
+//
+// The leading exponent e_0 can be restricted to [lo, hi). Those ranges are
+// contiguous in the order, so generation splits across threads by e_0.
+
+class MonomialEnumerator
+{
+public:
+    using Exponents = std::vector<int>;
+
+    MonomialEnumerator(size_t m, int d) : MonomialEnumerator(m, d, 0, d + 1) {}
+
+    MonomialEnumerator(size_t m, int d, int lo, int hi)
+        : d_(d), hi_(hi), sum_(lo), last_(0), done_(lo >= hi || lo > d), e_(m, 0)
+    {
+        if (m == 0 || d < 0)
+            throw std::invalid_argument("Number of variables m must be >0 and max degree d>=0");
+        if (lo < 0)
+            throw std::invalid_argument("Leading exponent range must be non-negative");
+        if (!done_)
+            e_[0] = lo;
+    }
+
+    bool done() const { return done_; }
+    const Exponents &operator*() const { return e_; }
+    const Exponents *operator->() const { return &e_; }
+
+    // Total degree of the current monomial
+    int degree() const { return sum_; }
+
+    MonomialEnumerator &operator++()
+    {
+        size_t m = e_.size();
+        if (sum_ < d_)
+        {
+            e_[m - 1]++;
+            sum_++;
+            last_ = m - 1;
+        }
+        else if (sum_ == 0 || last_ == 0)
+        {
+            done_ = true;
+            return *this;
+        }
+        else
+        {
+            sum_ -= e_[last_] - 1;
+            e_[last_] = 0;
+            e_[--last_]++;
+        }
+        if (e_[0] >= hi_)
+            done_ = true;
+        return *this;
+    }
+
+    // C(m+d, d), the number of monomials of degree <= d in m variables
+    static std::uint64_t count(size_t m, int d)
+    {
+        std::uint64_t r = 1;
+        for (int i = 1; i <= d; i++)
+        {
+            if (r > std::numeric_limits<std::uint64_t>::max() / (m + i))
+                throw std::overflow_error("Monomial count overflows 64 bits");
+            r = r * (m + i) / i;
+        }
+        return r;
+    }
+
+    // Number of monomials with leading exponent k
+    static std::uint64_t countLeading(size_t m, int d, int k)
+    {
+        if (k < 0 || k > d)
+            return 0;
+        return m == 1 ? 1 : count(m - 1, d - k);
+    }
+
+private:
+    int d_;
+    int hi_;
+    int sum_;
+    size_t last_;
+    bool done_;
+    Exponents e_;
+};
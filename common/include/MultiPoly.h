@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <numeric>
@@ -10,7 +11,11 @@
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <type_traits>
+#include <thread>
+#include <atomic>
 #include "NTL/ZZ_pX.h" 
+#include "MonomialEnumerator.h"
 // Sparse multivariate polynomial template class
 // Coeff: coefficient type (e.g., int, double, NTL::ZZ_p, etc.)
 // Constructs with:
@@ -32,6 +37,15 @@ public:
             throw std::invalid_argument("Number of variables m must be >0 and max degree d>=0");
     }
 
+    // Bulk constructor from terms already in strictly increasing exponent
+    // order, e.g. from MonomialEnumerator; see appendSorted
+    MultiPoly(size_t m, int d, std::vector<std::pair<Exponents, Coeff>> &&sorted)
+        : MultiPoly(m, d)
+    {
+        for (auto &[e, c] : sorted)
+            appendSorted(std::move(e), c);
+    }
+
     // Accessors
     size_t varCount() const { return varCount_; }
     int maxDegree() const { return maxDegree_; }
@@ -52,6 +66,21 @@ public:
             terms_.erase(e);
     }
 
+    // Add term c * x^e where e is greater than every exponent vector already
+    // present. The term goes in at the end of the map with no search.
+    void appendSorted(Exponents &&e, const Coeff &c)
+    {
+        if (e.size() != varCount_)
+            throw std::invalid_argument("Exponent vector must have one entry per variable");
+        if (!terms_.empty() && !(terms_.rbegin()->first < e))
+            throw std::invalid_argument("appendSorted needs increasing exponent vectors");
+        if (std::accumulate(e.begin(), e.end(), 0) > maxDegree_)
+            throw std::out_of_range("Monomial total degree exceeds maxDegree");
+        if (c == Coeff(0))
+            return;
+        terms_.emplace_hint(terms_.end(), std::move(e), c);
+    }
+
     // Polynomial addition: unify dimensions and degree bounds
     MultiPoly operator+(const MultiPoly &B) const
     {
@@ -73,9 +102,17 @@ public:
         return R;
     }
 
-    // Polynomial multiplication
+    // Polynomial multiplication. Over ZZ_p, products whose Kronecker image
+    // is no longer than the number of term pairs go through mulKronecker.
     MultiPoly operator*(const MultiPoly &B) const
     {
+        if constexpr (std::is_same_v<Coeff, NTL::ZZ_p>)
+        {
+            std::vector<long> radix;
+            long size = kroneckerRadix(B, radix);
+            if (size > 0 && static_cast<double>(termCount()) * B.termCount() >= size)
+                return mulKronecker(B, radix);
+        }
         size_t newVar = std::max(varCount_, B.varCount_);
         int newDeg = maxDegree_ + B.maxDegree_;
         MultiPoly R(newVar, newDeg);
@@ -96,6 +133,20 @@ public:
         return R;
     }
 
+    // Product by Kronecker substitution, for ZZ_p coefficients. With r_i one
+    // more than the largest exponent of x_i in the product, x_i is sent to
+    // u^{w_i}, w_i = r_{i+1} * ... * r_{m-1}; both images are multiplied as
+    // ZZ_pX (FFT-based in NTL) and the exponents read back in mixed radix.
+    // Since x_{m-1} is the least significant digit, the coefficients of the
+    // product come out in the lexicographic order of the term map.
+    MultiPoly mulKronecker(const MultiPoly &B) const
+    {
+        std::vector<long> radix;
+        if (kroneckerRadix(B, radix) == 0)
+            throw std::overflow_error("Kronecker image of the product is too long");
+        return mulKronecker(B, radix);
+    }
+
     // Evaluate at a point pts (length == varCount_)
     Coeff evaluate(const std::vector<Coeff> &pts) const
     {
@@ -149,6 +200,76 @@ public:
     size_t termCount() const { return terms_.size(); }
 
 private:
+    // Image length above which mulKronecker is refused
+    static constexpr long kroneckerLimit = 1L << 26;
+
+    // mulKronecker with the radix already computed by kroneckerRadix
+    MultiPoly mulKronecker(const MultiPoly &B, const std::vector<long> &radix) const
+    {
+        static_assert(std::is_same_v<Coeff, NTL::ZZ_p>, "mulKronecker needs ZZ_p coefficients");
+        size_t newVar = std::max(varCount_, B.varCount_);
+        MultiPoly R(newVar, maxDegree_ + B.maxDegree_);
+
+        NTL::ZZ_pX c;
+        if (this == &B)
+            NTL::sqr(c, kroneckerImage(radix));
+        else
+            NTL::mul(c, kroneckerImage(radix), B.kroneckerImage(radix));
+
+        Exponents e(newVar);
+        for (long k = 0; k <= NTL::deg(c); k++)
+        {
+            const Coeff &ck = NTL::coeff(c, k);
+            if (NTL::IsZero(ck))
+                continue;
+            long r = k;
+            for (size_t i = newVar; i-- > 0;)
+            {
+                e[i] = r % radix[i];
+                r /= radix[i];
+            }
+            R.terms_.emplace_hint(R.terms_.end(), e, ck);
+        }
+        return R;
+    }
+
+    // Per-variable radix r_i for the product with B; returns the image
+    // length prod r_i, or 0 if it exceeds kroneckerLimit
+    long kroneckerRadix(const MultiPoly &B, std::vector<long> &radix) const
+    {
+        radix.assign(std::max(varCount_, B.varCount_), 1);
+        for (const auto *P : {this, &B})
+        {
+            std::vector<long> top(radix.size(), 0);
+            for (const auto &[e, c] : P->terms_)
+                for (size_t i = 0; i < e.size(); i++)
+                    top[i] = std::max<long>(top[i], e[i]);
+            for (size_t i = 0; i < radix.size(); i++)
+                radix[i] += top[i];
+        }
+        long size = 1;
+        for (long r : radix)
+        {
+            if (size > kroneckerLimit / r)
+                return 0;
+            size *= r;
+        }
+        return size;
+    }
+
+    NTL::ZZ_pX kroneckerImage(const std::vector<long> &radix) const
+    {
+        NTL::ZZ_pX f;
+        for (auto it = terms_.rbegin(); it != terms_.rend(); ++it)
+        {
+            long k = 0;
+            for (size_t i = 0; i < radix.size(); i++)
+                k = k * radix[i] + (i < it->first.size() ? it->first[i] : 0);
+            NTL::SetCoeff(f, k, it->second);
+        }
+        return f;
+    }
+
     size_t varCount_;
     int maxDegree_;
     std::map<Exponents, Coeff> terms_;
@@ -156,24 +277,47 @@ private:
 
 template <typename Coeff>
 MultiPoly<Coeff> generateFullPoly(size_t m, int d, const Coeff &c = Coeff(1))
+{
+    MultiPoly<Coeff> P(m, d);
+    for (MonomialEnumerator it(m, d); !it.done(); ++it)
+        P.appendSorted(typename MultiPoly<Coeff>::Exponents(*it), c);
+    return P;
+}
+
+// generateFullPoly with the exponent vectors built on up to `threads`
+// threads, one leading exponent e_0 at a time (largest blocks first). The
+// blocks are then appended in order; workers never touch Coeff.
+template <typename Coeff>
+MultiPoly<Coeff> generateFullPoly(size_t m, int d, const Coeff &c, unsigned threads)
 {
     using Exponents = typename MultiPoly<Coeff>::Exponents;
     MultiPoly<Coeff> P(m, d);
-    Exponents e(m);
-    std::function<void(int, int)> rec = [&](int idx, int rem)
+    if (d < 0)
+        return P;
+    std::vector<std::vector<Exponents>> block(d + 1);
+    std::atomic<int> next(0);
+    auto work = [&]()
     {
-        if (idx == (int)m)
-        {
-            P.addTerm(e, c);
-            return;
-        }
-        for (int k = 0; k <= rem; ++k)
+        for (int k; (k = next++) <= d;)
         {
-            e[idx] = k;
-            rec(idx + 1, rem - k);
+            block[k].reserve(MonomialEnumerator::countLeading(m, d, k));
+            for (MonomialEnumerator it(m, d, k, k + 1); !it.done(); ++it)
+                block[k].push_back(*it);
         }
     };
-    rec(0, d);
+    threads = std::max(1u, std::min<unsigned>(threads, d + 1));
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < threads; w++)
+        pool.emplace_back(work);
+    work();
+    for (auto &th : pool)
+        th.join();
+    for (auto &b : block)
+    {
+        for (auto &e : b)
+            P.appendSorted(std::move(e), c);
+        std::vector<Exponents>().swap(b);
+    }
     return P;
 }
 
@@ -192,8 +336,9 @@ MultiPoly<Coeff> polyPow(const MultiPoly<Coeff> &g, int exp, int bound)
     {
         if (exp & 1)
             result = result * base;
-        base = base * base;
         exp >>= 1;
+        if (exp > 0)
+            base = base * base;
     }
     return result;
 }
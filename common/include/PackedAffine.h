@@ -0,0 +1,74 @@
+// PackedAffine.h
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include "helper.h"
+#include "MultiPoly.h"
+
+// m affine univariate polynomials ell_j(u) = c_j + s_j * u, as used for the
+// SP4/RH4 public key. The coefficients are packed pairwise in one flat array
+// (c_0 s_0 c_1 s_1 ...), so evaluating every ell_j at one point is a single
+// forward pass with one multiplication and one addition per variable.
+
+class PackedAffine
+{
+public:
+    PackedAffine() = default;
+
+    // coeffs holds 2m elements, constant term first for each variable
+    explicit PackedAffine(const Vec<Fq> &coeffs);
+
+    // m polynomials with uniformly random coefficients
+    static PackedAffine random(long m);
+
+    long length() const { return coeffs_.length() / 2; }
+    const Fq &constant(long j) const { return coeffs_[2 * j]; }
+    const Fq &slope(long j) const { return coeffs_[2 * j + 1]; }
+    const Vec<Fq> &coeffs() const { return coeffs_; }
+
+    // out[j] = ell_j(a) for every j
+    void evaluate(Vec<Fq> &out, const Fq &a) const;
+    Fq evaluate(long j, const Fq &a) const;
+
+    // F(ell_0(u), ..., ell_{m-1}(u)) as a univariate polynomial, obtained by
+    // evaluating F at deg F + 1 points and interpolating. Poly is any form of
+    // F with varCount(), maxDegree() and evaluate(), e.g. MultiPoly<Fq>.
+    template <typename Poly>
+    ZZ_pX compose(const Poly &F) const;
+
+    // The same composition built term by term from the linear factors of
+    // the variables each term contains, O(terms * d^2) field operations
+    // however large m is. For sparse F such as a key update; compose() is
+    // the cheaper choice for dense F.
+    ZZ_pX composeTerms(const MultiPoly<Fq> &F) const;
+
+    // ell_j as a univariate MultiPoly, e.g. for printing
+    MultiPoly<Fq> poly(long j) const;
+
+private:
+    Vec<Fq> coeffs_;
+};
+
+template <typename Poly>
+ZZ_pX PackedAffine::compose(const Poly &F) const
+{
+    if (static_cast<long>(F.varCount()) != length())
+        throw std::invalid_argument("PackedAffine size must match the variables of F");
+
+    long n = F.maxDegree() + 1;
+    Vec<Fq> u, v, x;
+    u.SetLength(n);
+    v.SetLength(n);
+    std::vector<Fq> pts;
+    for (long i = 0; i < n; i++)
+    {
+        u[i] = i;
+        evaluate(x, u[i]);
+        pts.assign(x.begin(), x.end());
+        v[i] = F.evaluate(pts);
+    }
+    ZZ_pX f;
+    interpolate(f, u, v);
+    return f;
+}
@@ -0,0 +1,41 @@
+// PolyLoader.h
+#pragma once
+
+#include <iostream>
+#include <string>
+#include "helper.h"
+#include "MultiPoly.h"
+
+// Bulk loading of large F from files.
+//
+// Text format: a header line "m d", then one term per line
+//
+//   c v_1 v_2 ... v_r
+//
+// where c is a decimal integer (reduced mod q, may be negative) and
+// v_1..v_r, r <= d, are the variable indices of the monomial with
+// repetition and in any order (3 0 0 is x0^2*x3). Blank lines and lines
+// starting with '#' are skipped; repeated monomials are summed.
+//
+// Loading never searches the term map. The input is cut into line-aligned
+// chunks that are parsed, on up to `threads` threads, into flat arrays of
+// variable slots and sorted. The sorted runs are merged straight into the
+// result in map order with MultiPoly::appendSorted, each run freed once
+// consumed, so peak memory is the slot arrays plus the result. Binary
+// MultiPoly sections take the same path and skip the sort when already in
+// map order, as everything writeBinary produces is.
+
+// Text format from a file, mapped rather than read
+MultiPoly<Fq> loadTextPoly(const std::string &path, unsigned threads = 1);
+
+void writeTextPoly(std::ostream &out, const MultiPoly<Fq> &P);
+
+// The index-th MultiPoly section of a binary file (see Serialize.h)
+MultiPoly<Fq> loadBinaryPoly(const std::string &path, size_t index = 0, unsigned threads = 1);
+
+// Text file to a single-MultiPoly binary file without building a MultiPoly,
+// for F that does not fit in memory; evaluate the result with MappedPoly or
+// StreamedPoly. Chunks of at most 64 MiB of text are sorted and spilled to
+// temporary files, then merged from disk in two passes (count, then write),
+// so memory holds `threads` chunks plus one term per spilled run.
+void convertTextPoly(const std::string &textPath, const std::string &binPath, unsigned threads = 1);
@@ -0,0 +1,193 @@
+// PrecomputePool.h
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "helper.h"
+
+// Bounded pool of input-independent precomputation, e.g. ProbGenOffline
+// tuples. The pool is filled either synchronously with fill() or by a
+// background producer started with start(), which keeps it topped up to
+// capacity. take() hands out one item; if the pool is empty it waits for
+// the producer, or produces inline when no producer is running.
+//
+// The producer thread runs under the ZZ_p modulus that was current when
+// start() was called, and gets its own random stream seeded from the
+// caller's, so tuples made in the background are never repeated.
+
+template <typename T>
+class PrecomputePool
+{
+public:
+    using Producer = std::function<void(T &)>;
+
+    PrecomputePool(Producer produce, size_t capacity)
+        : produce_(std::move(produce)), capacity_(capacity)
+    {
+        if (!produce_)
+            throw std::invalid_argument("PrecomputePool requires a producer");
+        if (capacity_ == 0)
+            throw std::invalid_argument("PrecomputePool capacity must be > 0");
+    }
+
+    ~PrecomputePool() { stop(); }
+    PrecomputePool(const PrecomputePool &) = delete;
+    PrecomputePool &operator=(const PrecomputePool &) = delete;
+
+    // Produce up to n items on the calling thread, never beyond capacity
+    void fill(size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (items_.size() >= capacity_)
+                    return;
+            }
+            T item;
+            produce_(item);
+            push(std::move(item));
+        }
+    }
+
+    // Keep the pool full from a background thread until stop().
+    // start() and stop() belong to the pool's owner; take() may be called
+    // from any thread.
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_)
+            return;
+        ZZ_pContext ctx;
+        ctx.save();
+        ZZ seed = RandomBits_ZZ(256);
+        stopping_ = false;
+        error_ = nullptr;
+        running_ = true;
+        worker_ = std::thread([this, ctx, seed]() { run(ctx, seed); });
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+        if (worker_.joinable())
+            worker_.join();
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+
+    // Take one item without waiting; false when the pool is empty
+    bool tryTake(T &out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        rethrow();
+        if (items_.empty())
+            return false;
+        pop(out, lock);
+        return true;
+    }
+
+    // Take one item, waiting for the producer or producing inline
+    T take()
+    {
+        T out;
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this]() { return !items_.empty() || !producing() || error_; });
+        rethrow();
+        if (!items_.empty())
+        {
+            pop(out, lock);
+            return out;
+        }
+        lock.unlock();
+        produce_(out);
+        return out;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    bool producing() const { return running_ && !stopping_; }
+
+    void rethrow()
+    {
+        if (error_)
+        {
+            std::exception_ptr e = error_;
+            error_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    void push(T &&item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(std::move(item));
+        }
+        notEmpty_.notify_one();
+    }
+
+    void pop(T &out, std::unique_lock<std::mutex> &lock)
+    {
+        out = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+    }
+
+    void run(const ZZ_pContext &ctx, const ZZ &seed)
+    {
+        ctx.restore();
+        SetSeed(seed);
+        try
+        {
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    notFull_.wait(lock, [this]() { return stopping_ || items_.size() < capacity_; });
+                    if (stopping_)
+                        return;
+                }
+                T item;
+                produce_(item);
+                push(std::move(item));
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+            stopping_ = true;
+        }
+        notEmpty_.notify_all();
+    }
+
+    Producer produce_;
+    size_t capacity_;
+    std::deque<T> items_;
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::thread worker_;
+    bool running_ = false;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+};
@@ -0,0 +1,142 @@
+// PreparedPoly.h
+#pragma once
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <cassert>
+#include "MultiPoly.h"
+
+// Server-side preprocessed form of a MultiPoly, built once at KeyGen.
+//
+// The monomials of F are arranged in an evaluation DAG: node 0 is the
+// constant monomial 1 and every other node is (parent node) * x_var, with
+// parents always stored before their children. Evaluating at a point then
+// costs one multiplication per node plus one per term, instead of a
+// power-table lookup per variable per term as in MultiPoly::evaluate.
+// Exponent vectors are replaced by narrow (parent, var) index pairs and the
+// coefficients sit in a flat array sorted by node for a sequential pass.
+
+template <typename Coeff>
+class PreparedPoly
+{
+public:
+    using Exponents = typename MultiPoly<Coeff>::Exponents;
+    using Index = std::uint32_t;
+
+    PreparedPoly() : varCount_(0), maxDegree_(0), parent_{0}, var_{0} {}
+
+    explicit PreparedPoly(const MultiPoly<Coeff> &F)
+        : varCount_(F.varCount()), maxDegree_(F.maxDegree())
+    {
+        if (varCount_ > std::numeric_limits<Index>::max())
+            throw std::out_of_range("Too many variables for PreparedPoly");
+
+        std::map<Exponents, Index> index;
+        index.emplace(Exponents(varCount_, 0), 0);
+        parent_.push_back(0);
+        var_.push_back(0);
+
+        std::vector<Index> nodes;
+        std::vector<const Coeff *> coeffs;
+        nodes.reserve(F.termCount());
+        coeffs.reserve(F.termCount());
+        for (const auto &[e, c] : F.terms())
+        {
+            nodes.push_back(node(index, e));
+            coeffs.push_back(&c);
+        }
+
+        // Order terms by node so the accumulation pass reads val[] forward
+        std::vector<size_t> order(nodes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return nodes[a] < nodes[b]; });
+
+        termNode_.reserve(order.size());
+        termCoeff_.reserve(order.size());
+        for (size_t j : order)
+        {
+            termNode_.push_back(nodes[j]);
+            termCoeff_.push_back(*coeffs[j]);
+        }
+    }
+
+    // Rebuild from raw DAG arrays, e.g. when loading a persisted key
+    PreparedPoly(size_t m, int d,
+                 std::vector<Index> parent, std::vector<Index> var,
+                 std::vector<Index> termNode, std::vector<Coeff> termCoeff)
+        : varCount_(m), maxDegree_(d), parent_(std::move(parent)), var_(std::move(var)),
+          termNode_(std::move(termNode)), termCoeff_(std::move(termCoeff))
+    {
+        if (parent_.empty() || parent_.size() != var_.size() || termNode_.size() != termCoeff_.size())
+            throw std::invalid_argument("Inconsistent PreparedPoly arrays");
+        for (size_t n = 1; n < parent_.size(); n++)
+            if (parent_[n] >= n || var_[n] >= varCount_)
+                throw std::invalid_argument("PreparedPoly node is not in topological order");
+        for (Index n : termNode_)
+            if (n >= parent_.size())
+                throw std::invalid_argument("PreparedPoly term refers to a missing node");
+    }
+
+    // Accessors
+    size_t varCount() const { return varCount_; }
+    int maxDegree() const { return maxDegree_; }
+    size_t termCount() const { return termNode_.size(); }
+    size_t nodeCount() const { return parent_.size(); }
+    const std::vector<Index> &parents() const { return parent_; }
+    const std::vector<Index> &vars() const { return var_; }
+    const std::vector<Index> &termNodes() const { return termNode_; }
+    const std::vector<Coeff> &termCoeffs() const { return termCoeff_; }
+
+    // Evaluate at a point pts (length == varCount_)
+    Coeff evaluate(const std::vector<Coeff> &pts) const
+    {
+        assert(pts.size() == varCount_);
+        std::vector<Coeff> val(parent_.size());
+        val[0] = Coeff(1);
+        for (size_t n = 1; n < parent_.size(); n++)
+            val[n] = val[parent_[n]] * pts[var_[n]];
+
+        Coeff sum = Coeff(0);
+        for (size_t j = 0; j < termNode_.size(); j++)
+            sum += termCoeff_[j] * val[termNode_[j]];
+        return sum;
+    }
+
+private:
+    // Return the node for monomial e, creating it and any missing ancestors.
+    // The parent divides out one power of the last variable present in e.
+    Index node(std::map<Exponents, Index> &index, const Exponents &e)
+    {
+        auto it = index.find(e);
+        if (it != index.end())
+            return it->second;
+
+        size_t v = e.size();
+        while (v > 0 && e[v - 1] == 0)
+            v--;
+        Exponents p = e;
+        p[v - 1]--;
+        Index par = node(index, p);
+
+        if (parent_.size() >= std::numeric_limits<Index>::max())
+            throw std::out_of_range("Too many monomials for PreparedPoly");
+        Index id = static_cast<Index>(parent_.size());
+        parent_.push_back(par);
+        var_.push_back(static_cast<Index>(v - 1));
+        index.emplace(e, id);
+        return id;
+    }
+
+    size_t varCount_;
+    int maxDegree_;
+    std::vector<Index> parent_;
+    std::vector<Index> var_;
+    std::vector<Index> termNode_;
+    std::vector<Coeff> termCoeff_;
+};
@@ -0,0 +1,161 @@
+// QuadraticPoly.h
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "MultiPoly.h"
+
+// Dense form of a polynomial of degree at most 2,
+//   F(x) = c + sum_i b_i x_i + sum_{i<=j} A_ij x_i x_j,
+// for the d = 2 evaluation keys. A is kept as its packed upper triangle:
+// row i holds A_ii..A_i,m-1 contiguously, so evaluation is a single forward
+// pass of dot products x_i * (b_i + sum_{j>=i} A_ij x_j) over flat arrays,
+// with no exponent vectors or map nodes. Storage is (m+1)(m+2)/2
+// coefficients whether or not they are zero, each a separate ZZ_p, so about
+// 5e7 field elements at m = 10^4: practical for m in the low thousands.
+
+template <typename Coeff>
+class QuadraticPoly
+{
+public:
+    using Exponents = typename MultiPoly<Coeff>::Exponents;
+
+    QuadraticPoly() : varCount_(0), maxDegree_(2), constant_(0) {}
+
+    // The zero polynomial in m variables
+    explicit QuadraticPoly(size_t m)
+        : varCount_(m), maxDegree_(2), constant_(0),
+          linear_(m, Coeff(0)), quad_(m * (m + 1) / 2, Coeff(0))
+    {
+        if (m == 0)
+            throw std::invalid_argument("Number of variables m must be >0");
+    }
+
+    explicit QuadraticPoly(const MultiPoly<Coeff> &F) : QuadraticPoly(F.varCount())
+    {
+        if (F.maxDegree() > 2)
+            throw std::invalid_argument("QuadraticPoly needs deg F <= 2");
+        maxDegree_ = F.maxDegree();
+        for (const auto &[e, c] : F.terms())
+            addTerm(e, c);
+    }
+
+    size_t varCount() const { return varCount_; }
+    int maxDegree() const { return maxDegree_; }
+
+    // Number of nonzero coefficients
+    size_t termCount() const
+    {
+        auto nz = [](const Coeff &c) { return !(c == Coeff(0)); };
+        return nz(constant_) + std::count_if(linear_.begin(), linear_.end(), nz) +
+               std::count_if(quad_.begin(), quad_.end(), nz);
+    }
+
+    Coeff &constant() { return constant_; }
+    const Coeff &constant() const { return constant_; }
+    Coeff &linear(size_t i) { return linear_.at(i); }
+    const Coeff &linear(size_t i) const { return linear_.at(i); }
+
+    // Coefficient of x_i x_j; (i, j) and (j, i) name the same entry
+    Coeff &quadratic(size_t i, size_t j) { return quad_.at(offset(i, j)); }
+    const Coeff &quadratic(size_t i, size_t j) const { return quad_.at(offset(i, j)); }
+
+    // Add term c * x^e
+    void addTerm(const Exponents &e, const Coeff &c)
+    {
+        if (e.size() != varCount_)
+            throw std::invalid_argument("Exponent vector must have one entry per variable");
+        size_t v[2];
+        int deg = 0;
+        for (size_t i = 0; i < e.size(); i++)
+        {
+            if (e[i] == 0)
+                continue;
+            if (e[i] < 0 || deg + e[i] > 2)
+                throw std::out_of_range("Monomial total degree exceeds 2");
+            for (int p = 0; p < e[i]; p++)
+                v[deg++] = i;
+        }
+        if (deg == 0)
+            constant_ += c;
+        else if (deg == 1)
+            linear_[v[0]] += c;
+        else
+            quad_[offset(v[0], v[1])] += c;
+    }
+
+    // For ZZ_p each row's dot product and the outer sum are accumulated as
+    // ZZ and reduced once, instead of after every product
+    Coeff evaluate(const std::vector<Coeff> &pts) const
+    {
+        if (pts.size() != varCount_)
+            throw std::invalid_argument("Point must have one value per variable");
+        const Coeff *row = quad_.data();
+        if constexpr (std::is_same_v<Coeff, NTL::ZZ_p>)
+        {
+            NTL::ZZ acc = rep(constant_), s;
+            NTL::ZZ_p r;
+            for (size_t i = 0; i < varCount_; i++)
+            {
+                s = rep(linear_[i]);
+                const Coeff *x = pts.data() + i;
+                for (size_t j = 0; j < varCount_ - i; j++)
+                    s += rep(row[j]) * rep(x[j]);
+                conv(r, s);
+                acc += rep(r) * rep(pts[i]);
+                row += varCount_ - i;
+            }
+            conv(r, acc);
+            return r;
+        }
+        else
+        {
+            Coeff acc = constant_;
+            for (size_t i = 0; i < varCount_; i++)
+            {
+                Coeff s = linear_[i];
+                const Coeff *x = pts.data() + i;
+                for (size_t j = 0; j < varCount_ - i; j++)
+                    s += row[j] * x[j];
+                acc += s * pts[i];
+                row += varCount_ - i;
+            }
+            return acc;
+        }
+    }
+
+private:
+    // Row i of the packed triangle starts after rows 0..i-1 of lengths m, m-1, ...
+    size_t offset(size_t i, size_t j) const
+    {
+        if (i > j)
+            std::swap(i, j);
+        if (j >= varCount_)
+            throw std::out_of_range("Variable index out of range");
+        return i * varCount_ - i * (i - 1) / 2 + (j - i);
+    }
+
+    size_t varCount_;
+    int maxDegree_;
+    Coeff constant_;
+    std::vector<Coeff> linear_;
+    std::vector<Coeff> quad_;
+};
+
+// Quadratic with every coefficient equal to c, the dense counterpart of
+// generateFullPoly(m, 2, c) for m too large to enumerate as MultiPoly terms
+template <typename Coeff>
+QuadraticPoly<Coeff> generateFullQuadratic(size_t m, const Coeff &c = Coeff(1))
+{
+    QuadraticPoly<Coeff> P(m);
+    P.constant() = c;
+    for (size_t i = 0; i < m; i++)
+    {
+        P.linear(i) = c;
+        for (size_t j = i; j < m; j++)
+            P.quadratic(i, j) = c;
+    }
+    return P;
+}
@@ -0,0 +1,170 @@
+// Serialize.h
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "helper.h"
+#include "MultiPoly.h"
+#include "PreparedPoly.h"
+#include "EvalKey.h"
+#include "PackedAffine.h"
+
+// Versioned binary format for keys, share matrices and polynomials.
+//
+// Every integer is little-endian and fixed width; every field element in a
+// section occupies the same number of bytes (elemBytes), so records can be
+// addressed directly without parsing. A file is
+//
+//   "MSVCBIN\0"  u32 version  u32 reserved
+//   section*
+//
+// and each section is a 16-byte header followed by its payload, padded so
+// the next section starts on an 8-byte boundary:
+//
+//   u32 tag  u32 elemBytes  u64 payloadBytes  payload  pad
+//
+// Sections holding Fq values start with the field modulus (elemBytes wide)
+// and are rejected when it differs from ZZ_p::modulus().
+//
+// A MultiPoly payload stores packed exponents: each monomial is written as
+// the ascending list of its variable indices (x0^2*x3 -> 0 0 3) in exactly
+// maxDegree slots of slotBytes each, padded with an all-ones sentinel.
+//
+//   modulus  u64 varCount  u32 maxDegree  u32 slotBytes  u64 termCount
+//   slots[termCount][maxDegree]  pad8  coeffs[termCount]
+//
+// MappedPoly evaluates such a section straight out of an mmap'ed file, so a
+// server can start on a multi-gigabyte key without reading it, and several
+// processes mapping the same file share its pages.
+
+constexpr std::uint32_t kBinaryVersion = 1;
+
+enum class BinaryTag : std::uint32_t
+{
+    ZZ = 1,
+    Fq = 2,
+    VecZZ = 3,
+    VecFq = 4,
+    MatFq = 5,
+    MultiPoly = 6,
+    PolyVec = 7,
+    EvalKey = 8,
+    PreparedPoly = 9
+};
+
+struct SectionHeader
+{
+    std::uint32_t tag;
+    std::uint32_t elemBytes;
+    std::uint64_t payloadBytes;
+};
+
+// File header
+void writeBinaryHeader(std::ostream &out);
+void readBinaryHeader(std::istream &in);
+
+// Sections; each read throws std::runtime_error on a malformed stream
+void writeBinary(std::ostream &out, const ZZ &x);
+void readBinary(std::istream &in, ZZ &x);
+void writeBinary(std::ostream &out, const Fq &x);
+void readBinary(std::istream &in, Fq &x);
+void writeBinary(std::ostream &out, const Vec<ZZ> &v);
+void readBinary(std::istream &in, Vec<ZZ> &v);
+void writeBinary(std::ostream &out, const Vec<Fq> &v);
+void readBinary(std::istream &in, Vec<Fq> &v);
+// Univariate polynomials are a VecFq section of coefficients, lowest first
+void writeBinary(std::ostream &out, const ZZ_pX &f);
+void readBinary(std::istream &in, ZZ_pX &f);
+// Affine keys are the VecFq section of their packed coefficients
+void writeBinary(std::ostream &out, const PackedAffine &L);
+void readBinary(std::istream &in, PackedAffine &L);
+void writeBinary(std::ostream &out, const Mat<Fq> &M);
+void readBinary(std::istream &in, Mat<Fq> &M);
+void writeBinary(std::ostream &out, const MultiPoly<Fq> &P);
+void readBinary(std::istream &in, MultiPoly<Fq> &P);
+void writeBinary(std::ostream &out, const Vec<MultiPoly<Fq>> &v);
+void readBinary(std::istream &in, Vec<MultiPoly<Fq>> &v);
+void writeBinary(std::ostream &out, const PreparedPoly<Fq> &P);
+void readBinary(std::istream &in, PreparedPoly<Fq> &P);
+
+// Evaluation keys store the server count followed by the single shared F
+void writeEvalKeyHeader(std::ostream &out, long k);
+long readEvalKeyHeader(std::istream &in);
+
+template <typename Poly>
+void writeBinary(std::ostream &out, const EvalKey<Poly> &ek)
+{
+    writeEvalKeyHeader(out, ek.length());
+    if (ek.length() > 0)
+        writeBinary(out, ek[0]);
+}
+
+template <typename Poly>
+void readBinary(std::istream &in, EvalKey<Poly> &ek)
+{
+    long k = readEvalKeyHeader(in);
+    ek.kill();
+    if (k == 0)
+        return;
+    Poly F;
+    readBinary(in, F);
+    ek = EvalKey<Poly>::share(std::move(F), k);
+}
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const unsigned char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char *data_;
+    size_t size_;
+};
+
+// Zero-copy view of a MultiPoly section inside a mapped file.
+// Monomials and coefficients are decoded on the fly during evaluation.
+class MappedPoly
+{
+public:
+    MappedPoly() = default;
+    MappedPoly(std::shared_ptr<const MappedFile> file, size_t sectionOffset);
+
+    // Map path and view its index-th MultiPoly section
+    static MappedPoly open(const std::string &path, size_t index = 0);
+
+    size_t varCount() const { return varCount_; }
+    int maxDegree() const { return maxDegree_; }
+    size_t termCount() const { return termCount_; }
+
+    // Variable index in slot s of term j, or -1 for an empty slot
+    long slot(size_t j, int s) const;
+    void coeff(Fq &c, size_t j) const;
+
+    Fq evaluate(const std::vector<Fq> &pts) const;
+
+    // Materialize as an ordinary MultiPoly
+    MultiPoly<Fq> load() const;
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    const unsigned char *slots_ = nullptr;
+    const unsigned char *coeffs_ = nullptr;
+    size_t varCount_ = 0;
+    int maxDegree_ = 0;
+    size_t termCount_ = 0;
+    unsigned slotBytes_ = 0;
+    unsigned elemBytes_ = 0;
+};
+
+// Offsets of every section in a mapped file, in order
+std::vector<std::pair<SectionHeader, size_t>> listSections(const MappedFile &file);
@@ -0,0 +1,58 @@
+// StragglerSim.h
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+#include "helper.h"
+
+// Response latency of one server, in ms, added to its measured compute time.
+//   Constant:     base
+//   Exponential:  base + Exp(mean = scale)
+//   LogNormal:    base + LogNormal(median = scale, sigma = shape)
+//   Pareto:       base + Pareto(x_m = scale, alpha = shape)
+struct LatencyModel
+{
+    enum Kind { Constant, Exponential, LogNormal, Pareto };
+
+    Kind kind = Constant;
+    double base = 0;
+    double scale = 0;
+    double shape = 0;
+
+    double sample(std::mt19937_64 &rng) const;
+
+    // "const:B", "exp:B:MEAN", "lognormal:B:MEDIAN:SIGMA" or "pareto:B:XM:ALPHA"
+    static LatencyModel parse(const std::string &spec);
+
+    // Comma-separated list of models, e.g. "exp:1:2,exp:1:20"
+    static std::vector<LatencyModel> parseList(const std::string &specs);
+    std::string toString() const;
+};
+
+// Simulated rounds of n servers that answer with independent latencies.
+// The client needs the first k responses, so a round ends at the k-th
+// arrival; with n = k that is the slowest server, with n > k the n - k
+// slowest are never waited for.
+class StragglerSim
+{
+public:
+    // Server i uses models[i % models.size()]: one model for all servers,
+    // a repeating pattern, or one model per server
+    StragglerSim(const std::vector<LatencyModel> &models, long n, uint64_t seed = 1);
+
+    long servers() const { return (long)models_.size(); }
+
+    // arrival[i] = compute_ms[i] + a fresh latency draw for server i
+    void arrivals(std::vector<double> &arrival, const std::vector<double> &compute_ms);
+
+    // The first k responders in order of arrival; returns the k-th arrival time
+    static double firstK(Vec<long> &idx, const std::vector<double> &arrival, long k);
+
+    // p-th percentile (0..100) of v by nearest rank
+    static double percentile(std::vector<double> v, double p);
+
+private:
+    std::vector<LatencyModel> models_;
+    std::mt19937_64 rng_;
+};
@@ -0,0 +1,110 @@
+// StreamedPoly.h
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "helper.h"
+#include "MultiPoly.h"
+
+// Out-of-core evaluation for keys that do not fit in memory.
+//
+// Both classes work on the MultiPoly section layout of Serialize.h, so a
+// term file is an ordinary binary key file that MappedPoly and readBinary
+// also accept. Neither side ever holds more than one chunk of terms.
+
+constexpr size_t kDefaultChunkTerms = size_t(1) << 16;
+
+// Writes a single-MultiPoly binary file term by term.
+// The number of terms must be known up front because slots and coefficients
+// live in separate regions of the section.
+class TermFileWriter
+{
+public:
+    TermFileWriter(const std::string &path, size_t m, int d, std::uint64_t termCount,
+                   size_t chunkTerms = kDefaultChunkTerms);
+    ~TermFileWriter();
+    TermFileWriter(const TermFileWriter &) = delete;
+    TermFileWriter &operator=(const TermFileWriter &) = delete;
+
+    // Append a term given by its exponent vector
+    void addTerm(const MultiPoly<Fq>::Exponents &e, const Fq &c);
+
+    // Append a term given by its ascending variable indices (x0^2*x3 -> 0 0 3)
+    void addTerm(const std::vector<size_t> &vars, const Fq &c);
+
+    // Flush and close; throws if fewer terms were added than announced.
+    // The destructor also flushes buffered terms, but cannot report a write
+    // failure or a short count, so call close() to have those checked.
+    void close();
+
+    std::uint64_t written() const { return written_; }
+
+private:
+    void flush();
+
+    int fd_;
+    size_t m_;
+    int d_;
+    unsigned elemBytes_;
+    unsigned slotBytes_;
+    std::uint64_t termCount_;
+    std::uint64_t written_ = 0;
+    std::uint64_t flushed_ = 0;
+    std::uint64_t slotsPos_;
+    std::uint64_t coeffsPos_;
+    std::uint64_t endPos_;
+    size_t chunkTerms_;
+    std::vector<unsigned char> slots_;
+    std::vector<unsigned char> coeffs_;
+};
+
+// Number of monomials of degree <= d in m variables, C(m+d, d)
+std::uint64_t fullTermCount(size_t m, int d);
+
+// Stream the complete degree-d polynomial in m variables to path,
+// drawing each coefficient from coeff(). Terms are written in graded order.
+void writeFullPoly(const std::string &path, size_t m, int d,
+                   const std::function<Fq()> &coeff,
+                   size_t chunkTerms = kDefaultChunkTerms);
+
+// Evaluates a MultiPoly section by sequential chunked reads.
+// While one chunk is being accumulated the next is read on a background
+// thread, so evaluation runs at the speed of the slower of disk and
+// field arithmetic. The reader thread only moves bytes and never touches NTL.
+class StreamedPoly
+{
+public:
+    StreamedPoly() = default;
+    explicit StreamedPoly(const std::string &path, size_t index = 0,
+                          size_t chunkTerms = kDefaultChunkTerms);
+
+    size_t varCount() const { return varCount_; }
+    int maxDegree() const { return maxDegree_; }
+    size_t termCount() const { return termCount_; }
+    size_t chunkTerms() const { return chunkTerms_; }
+
+    Fq evaluate(const std::vector<Fq> &pts) const;
+
+private:
+    struct Chunk
+    {
+        std::vector<unsigned char> slots;
+        std::vector<unsigned char> coeffs;
+        size_t count = 0;
+    };
+
+    void read(Chunk &chunk, size_t first) const;
+
+    std::shared_ptr<const int> fd_;
+    std::uint64_t slotsPos_ = 0;
+    std::uint64_t coeffsPos_ = 0;
+    size_t varCount_ = 0;
+    int maxDegree_ = 0;
+    size_t termCount_ = 0;
+    unsigned slotBytes_ = 0;
+    unsigned elemBytes_ = 0;
+    size_t chunkTerms_ = kDefaultChunkTerms;
+};
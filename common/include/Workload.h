@@ -0,0 +1,51 @@
+// Workload.h
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include "helper.h"
+#include "MultiPoly.h"
+
+// Benchmark workloads for the timetests.
+//   Full:   every monomial of degree <= d with one coefficient drawn from
+//           `seed` and X = (1, 2, ..., m), the original timetest workload
+//   Sparse: `terms` distinct random monomials and a random X, both drawn
+//           from `seed`, so a run is reproducible across schemes
+//
+// For Sparse, each variable is active with probability `density` (at least
+// one is), and every monomial uses active variables only. Term degrees are
+// uniform on 0..d, all d (Top), or geometric with ratio 1/2 from d down
+// (Geometric, most terms near degree d). Coefficients are uniform in Fq,
+// small (1..2^16) or all one. When `terms` is over half the monomials
+// available, they are sampled uniformly without replacement instead, and
+// the degree distribution no longer applies.
+struct WorkloadSpec
+{
+    enum Kind { Full, Sparse };
+    enum DegreeDist { Uniform, Top, Geometric };
+    enum CoeffDist { Random, Small, One };
+
+    Kind kind = Full;
+    long terms = 0;
+    double density = 1.0;
+    DegreeDist degree = Uniform;
+    CoeffDist coeff = Random;
+    uint64_t seed = 1;
+
+    // "full" or "sparse:TERMS:DENSITY:DEGREE:COEFF:SEED" with DEGREE one of
+    // uniform, top, geom and COEFF one of random, small, one; trailing fields
+    // may be omitted (defaults 1, uniform, random, 1)
+    static WorkloadSpec parse(const std::string &spec);
+    std::string toString() const;
+};
+
+// F in m variables of degree at most d; throws if the active variables
+// cannot supply `terms` distinct monomials
+MultiPoly<Fq> generateWorkload(const WorkloadSpec &spec, size_t m, int d);
+
+// The input X of length m for spec
+Vec<Fq> generateWorkloadInput(const WorkloadSpec &spec, long m);
+
+// Uniform element of Fq from rng, independent of NTL's own random stream
+Fq randomFq(std::mt19937_64 &rng);
@@ -40,6 +40,100 @@ ZZ compute_g_fa(const ZZ_pX &f,
                   const ZZ &g,
                   const ZZ &mod);
 
+// Fixed-base exponentiation with a precomputed comb table.
+// table[i][j] = g^(j * 2^(i*window)), so g^e costs one MulMod per window of e
+// and no squarings. Worth it once the same base is raised many times.
+class FixedBaseExp {
+public:
+    FixedBaseExp(const ZZ &g, const ZZ &mod, long maxBits, long window = 6);
+
+    void power(ZZ &x, const ZZ &e) const;
+    ZZ power(const ZZ &e) const { ZZ x; power(x, e); return x; }
+
+    // Window width that minimises table build plus uses exponentiations
+    static long bestWindow(long maxBits, long uses);
+
+private:
+    ZZ g_;
+    ZZ mod_;
+    long maxBits_;
+    long window_;
+    std::vector<std::vector<ZZ>> table_;
+};
+
+// V[i][j] = i^j for the share points i = 0..points-1 and j = 0..cols-1
+void Vandermonde(Mat<Fq> &V, long points, long cols);
+
+// x[i] = 1/a[i] with a single field inversion (Montgomery's trick)
+void BatchInverse(Vec<Fq> &x, const Vec<Fq> &a);
+
+// w[i] such that f(x) = sum w[i] * f(pts[i]) for every f of degree < pts.length()
+void LagrangeWeights(Vec<Fq> &w, const Vec<Fq> &pts, const Fq &x);
+
+// LagrangeWeights for the share points 0..k-1 in O(k), using the closed form
+// prod_{j != i} (i - j) = (-1)^(k-1-i) * i! * (k-1-i)!
+void ShareWeights(Vec<Fq> &w, long k, const Fq &x);
+
+// Share points of the first k responders, pts[r] = idx[r], where idx[r] is
+// the server that sent response r. Throws unless idx holds at least k
+// distinct servers in [0, n).
+void ResponderPoints(Vec<Fq> &pts, const Vec<long> &idx, long k, long n);
+
+// Common variable count m and largest degree d of the outputs F_1..F_r of a
+// vector-valued F. Throws if F is empty or the outputs differ in m.
+void SystemShape(long &m, int &d, const Vec<MultiPoly<Fq>> &F);
+
+// All outputs of a vector-valued F at pts, for ComputeMulti
+void EvaluateAll(std::vector<Fq> &out, const Vec<MultiPoly<Fq>> &F, const std::vector<Fq> &pts);
+
+// Gao decoding of a Reed-Solomon codeword: f of degree < dim that agrees with
+// vals[i] at pts[i] for all but at most (n - dim) / 2 positions, which are
+// returned in bad. Returns false if there is no such f.
+bool DecodeRS(ZZ_pX &f, Vec<long> &bad, const Vec<Fq> &pts, const Vec<Fq> &vals, long dim);
+
+// Decodes every column j of the responses pi (row r from server idx[r]) as a
+// codeword of dimension dims[j] over all responder points. at0[j] is the
+// decoded polynomial at 0 and bad lists, in ascending order, every server
+// whose row disagrees in some column. Returns false if any column fails.
+bool DecodeResponses(Vec<Fq> &at0, Vec<long> &bad, const Mat<Fq> &pi, const Vec<long> &idx,
+                     const Vec<long> &dims, long n);
+
+// Single-column DecodeResponses for schemes that return one value per
+// server; phi is the whole decoded polynomial, not just its value at 0.
+bool DecodeResponse(ZZ_pX &phi, Vec<long> &bad, const Vec<Fq> &pi, const Vec<long> &idx, long dim, long n);
+
+// M such that the coefficients of the interpolant through (i, y[i]),
+// i = 0..points-1, are M * y; the inverse of Vandermonde(points, points)
+void InterpolationMatrix(Mat<Fq> &M, long points);
+
+// prod bases[i]^exps[i] mod `mod` by Pippenger's bucket method.
+// Exponents must be non-negative; cost is about bits * (1 + N / window) MulMods.
+ZZ MultiExp(const Vec<ZZ> &bases, const Vec<ZZ> &exps, const ZZ &mod);
+
+// Small-exponent batch test of g^u[n] == h[n]^v[n] (mod `mod`) for all n, where
+// g and every h[n] lie in the subgroup of order `ord`. Each round folds the
+// instances with random secbits-bit weights into one multi-exponentiation;
+// a failing range is bisected, so ok[n] reports every instance individually.
+// Returns true iff all instances pass.
+bool BatchExpCheck(std::vector<bool> &ok, const ZZ &g, const Vec<ZZ> &h,
+                   const Vec<ZZ> &u, const Vec<ZZ> &v,
+                   const ZZ &ord, const ZZ &mod, long secbits = 64);
+
+// Small-exponent batch test that g^gExp[n] * prod_j bases[n][j]^exps[n][j] == 1
+// for all n, with every base in the subgroup of order `ord`. All instances are
+// folded into one multi-exponentiation with g merged into a single base;
+// failures are bisected as in BatchExpCheck.
+bool BatchProductCheck(std::vector<bool> &ok, const ZZ &g, const Vec<ZZ> &gExp,
+                       const Vec<Vec<ZZ>> &bases, const Vec<Vec<ZZ>> &exps,
+                       const ZZ &ord, const ZZ &mod, long secbits = 64);
+
+// Check g^{phi_j(alpha)} == target[j] for every column j of pi, where column j
+// holds the shares of phi_j at 0..k-1 and gPows[i] = g^{alpha^(i+1)}. The
+// columns are folded with random secbits-bit weights, so one compute_g_fa
+// and one MultiExp over the targets replace r of each. phi0[j] = phi_j(0).
+bool FoldedPowerCheck(Vec<Fq> &phi0, const Mat<Fq> &pi, const Vec<ZZ> &gPows, const Vec<ZZ> &target,
+                      const ZZ &g, const ZZ &mod, long secbits = 64);
+
 
 class SimpleTimer {
 private:
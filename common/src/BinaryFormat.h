@@ -0,0 +1,39 @@
+// BinaryFormat.h
+#pragma once
+
+// Layout constants and byte helpers of the binary format described in
+// Serialize.h, shared by the stream readers/writers, MappedPoly and the
+// term-file streaming in StreamedPoly.cpp. Internal to the common library.
+
+#include <cstddef>
+#include <cstdint>
+#include "Serialize.h"
+
+namespace binfmt
+{
+inline constexpr char kMagic[8] = {'M', 'S', 'V', 'C', 'B', 'I', 'N', '\0'};
+inline constexpr size_t kFileHeaderBytes = 16;
+inline constexpr size_t kSectionHeaderBytes = 16;
+// Modulus followed by u64 varCount, u32 maxDegree, u32 slotBytes, u64 termCount
+inline constexpr size_t kMultiPolyMetaBytes = 24;
+
+inline void storeLE(unsigned char *p, std::uint64_t v, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+inline std::uint64_t loadLE(const unsigned char *p, unsigned n)
+{
+    std::uint64_t v = 0;
+    for (unsigned i = 0; i < n; i++)
+        v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+inline std::uint64_t padded(std::uint64_t bytes) { return (bytes + 7) & ~std::uint64_t(7); }
+
+// MultiPoly exponent slots: 2 bytes when every index and the sentinel fit
+inline unsigned slotBytesFor(size_t varCount) { return varCount < 0xFFFF ? 2 : 4; }
+inline std::uint64_t sentinel(unsigned slotBytes) { return slotBytes == 2 ? 0xFFFF : 0xFFFFFFFF; }
+} // namespace binfmt
@@ -0,0 +1,72 @@
+#include "PackedAffine.h"
+#include <stdexcept>
+
+PackedAffine::PackedAffine(const Vec<Fq> &coeffs) : coeffs_(coeffs)
+{
+    if (coeffs_.length() % 2 != 0)
+        throw std::invalid_argument("PackedAffine needs two coefficients per variable");
+}
+
+PackedAffine PackedAffine::random(long m)
+{
+    if (m < 0)
+        throw std::invalid_argument("PackedAffine size must be >= 0");
+    PackedAffine L;
+    L.coeffs_.SetLength(2 * m);
+    for (long i = 0; i < 2 * m; i++)
+        L.coeffs_[i] = random_ZZ_p();
+    return L;
+}
+
+void PackedAffine::evaluate(Vec<Fq> &out, const Fq &a) const
+{
+    long m = length();
+    out.SetLength(m);
+    const Fq *c = coeffs_.elts();
+    Fq *o = out.elts();
+    for (long j = 0; j < m; j++, c += 2)
+    {
+        mul(o[j], c[1], a);
+        o[j] += c[0];
+    }
+}
+
+Fq PackedAffine::evaluate(long j, const Fq &a) const
+{
+    if (j < 0 || j >= length())
+        throw std::out_of_range("PackedAffine index out of range");
+    return constant(j) + slope(j) * a;
+}
+
+ZZ_pX PackedAffine::composeTerms(const MultiPoly<Fq> &F) const
+{
+    if (static_cast<long>(F.varCount()) != length())
+        throw std::invalid_argument("PackedAffine size must match the variables of F");
+
+    ZZ_pX f, t, lin;
+    for (const auto &[e, c] : F.terms())
+    {
+        clear(t);
+        SetCoeff(t, 0, c);
+        for (size_t j = 0; j < e.size(); j++)
+        {
+            if (e[j] == 0)
+                continue;
+            clear(lin);
+            SetCoeff(lin, 0, constant(j));
+            SetCoeff(lin, 1, slope(j));
+            for (int r = 0; r < e[j]; r++)
+                mul(t, t, lin);
+        }
+        f += t;
+    }
+    return f;
+}
+
+MultiPoly<Fq> PackedAffine::poly(long j) const
+{
+    MultiPoly<Fq> p(1, 1);
+    p.addTerm({0}, constant(j));
+    p.addTerm({1}, slope(j));
+    return p;
+}
@@ -0,0 +1,503 @@
+#include "PolyLoader.h"
+#include "Serialize.h"
+#include "StreamedPoly.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+constexpr std::uint32_t kEmpty = 0xFFFFFFFF;
+
+// Terms as d slots each: ascending variable indices padded with kEmpty.
+// For slot arrays a and b, the exponent vector of a is smaller than that
+// of b exactly when a is lexicographically greater than b, so sorting
+// slots in descending order gives the order of the term map.
+struct Run
+{
+    int d = 0;
+    std::vector<std::uint32_t> slots;
+    std::vector<Fq> coeffs;
+    std::vector<std::uint32_t> order;
+
+    size_t size() const { return coeffs.size(); }
+    const std::uint32_t *term(size_t j) const { return slots.data() + j * d; }
+};
+
+int compareSlots(const std::uint32_t *a, const std::uint32_t *b, int d)
+{
+    for (int s = 0; s < d; s++)
+    {
+        if (a[s] != b[s])
+            return a[s] > b[s] ? -1 : 1;
+    }
+    return 0;
+}
+
+void sortRun(Run &run)
+{
+    run.order.resize(run.size());
+    std::iota(run.order.begin(), run.order.end(), 0);
+    bool sorted = true;
+    for (size_t j = 1; j < run.size() && sorted; j++)
+        sorted = compareSlots(run.term(j - 1), run.term(j), run.d) <= 0;
+    if (!sorted)
+    {
+        std::sort(run.order.begin(), run.order.end(), [&run](std::uint32_t a, std::uint32_t b) {
+            return compareSlots(run.term(a), run.term(b), run.d) < 0;
+        });
+    }
+}
+
+// Run fn(r) for r = 0..n-1 on up to `threads` threads under the caller's modulus
+template <typename Fn>
+void parallelFor(size_t n, unsigned threads, Fn fn)
+{
+    threads = std::max(1u, std::min<unsigned>(threads, n));
+    if (threads == 1)
+    {
+        for (size_t r = 0; r < n; r++)
+            fn(r);
+        return;
+    }
+    ZZ_pContext ctx;
+    ctx.save();
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < threads; w++)
+    {
+        pool.emplace_back([&, w, ctx]() {
+            ctx.restore();
+            try
+            {
+                for (size_t r = w; r < n; r += threads)
+                    fn(r);
+            }
+            catch (...)
+            {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+    for (auto &th : pool)
+        th.join();
+    for (auto &e : errors)
+    {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+// Position in a sorted in-memory run. The run is freed once consumed.
+struct RunCursor
+{
+    Run *run;
+    size_t pos = 0;
+
+    explicit RunCursor(Run &r) : run(&r) {}
+    bool valid() const { return pos < run->size(); }
+    const std::uint32_t *term() const { return run->term(run->order[pos]); }
+    const Fq &coeff() const { return run->coeffs[run->order[pos]]; }
+    void next()
+    {
+        if (++pos == run->size())
+            *run = Run();
+    }
+};
+
+// A sorted run in an anonymous temporary file, each term as its d slots
+// followed by elemBytes little-endian coefficient bytes
+class SpilledRun
+{
+public:
+    SpilledRun() = default;
+    ~SpilledRun()
+    {
+        if (file_)
+            std::fclose(file_);
+    }
+    SpilledRun(const SpilledRun &) = delete;
+    SpilledRun &operator=(const SpilledRun &) = delete;
+
+    void write(const Run &run, unsigned elemBytes)
+    {
+        file_ = std::tmpfile();
+        if (!file_)
+            throw std::runtime_error("Cannot create a temporary file for a sorted run");
+        d_ = run.d;
+        elemBytes_ = elemBytes;
+        size_ = run.size();
+        std::vector<unsigned char> buf(elemBytes);
+        for (size_t j = 0; j < size_; j++)
+        {
+            std::uint32_t k = run.order[j];
+            BytesFromZZ(buf.data(), rep(run.coeffs[k]), elemBytes);
+            if (std::fwrite(run.term(k), sizeof(std::uint32_t), d_, file_) != static_cast<size_t>(d_) ||
+                std::fwrite(buf.data(), 1, elemBytes, file_) != elemBytes)
+                throw std::runtime_error("Cannot write a sorted run to its temporary file");
+        }
+        if (std::fflush(file_) != 0)
+            throw std::runtime_error("Cannot write a sorted run to its temporary file");
+    }
+
+    FILE *file() const { return file_; }
+    int d() const { return d_; }
+    unsigned elemBytes() const { return elemBytes_; }
+    size_t size() const { return size_; }
+
+private:
+    FILE *file_ = nullptr;
+    int d_ = 0;
+    unsigned elemBytes_ = 0;
+    size_t size_ = 0;
+};
+
+// Position in a spilled run, read sequentially from its start
+struct SpillCursor
+{
+    const SpilledRun *run;
+    size_t pos = 0;
+    std::vector<std::uint32_t> slots;
+    std::vector<unsigned char> buf;
+    Fq c;
+
+    explicit SpillCursor(const SpilledRun &r)
+        : run(&r), slots(r.d()), buf(r.elemBytes())
+    {
+        std::rewind(run->file());
+        load();
+    }
+    bool valid() const { return pos < run->size(); }
+    const std::uint32_t *term() const { return slots.data(); }
+    const Fq &coeff() const { return c; }
+    void next()
+    {
+        pos++;
+        load();
+    }
+
+private:
+    void load()
+    {
+        if (!valid())
+            return;
+        if (std::fread(slots.data(), sizeof(std::uint32_t), slots.size(), run->file()) != slots.size() ||
+            std::fread(buf.data(), 1, buf.size(), run->file()) != buf.size())
+            throw std::runtime_error("Cannot read a sorted run back from its temporary file");
+        ZZ z;
+        ZZFromBytes(z, buf.data(), buf.size());
+        conv(c, z);
+    }
+};
+
+// Merge sorted cursors in map order, summing repeated monomials and passing
+// each term that does not cancel to sink(slots, c). Nothing beyond the
+// current term of each cursor is buffered.
+template <typename Cursor, typename Sink>
+void mergeInto(std::vector<Cursor> &src, int d, Sink sink)
+{
+    // Min-heap of cursor indices on their current terms
+    std::vector<size_t> heap;
+    auto after = [&src, d](size_t a, size_t b) { return compareSlots(src[a].term(), src[b].term(), d) > 0; };
+    for (size_t r = 0; r < src.size(); r++)
+    {
+        if (src[r].valid())
+            heap.push_back(r);
+    }
+    std::make_heap(heap.begin(), heap.end(), after);
+
+    std::vector<std::uint32_t> cur(d);
+    Fq acc;
+    bool have = false;
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), after);
+        Cursor &s = src[heap.back()];
+        if (have && compareSlots(cur.data(), s.term(), d) == 0)
+        {
+            acc += s.coeff();
+        }
+        else
+        {
+            if (have && !IsZero(acc))
+                sink(cur.data(), acc);
+            std::copy(s.term(), s.term() + d, cur.begin());
+            acc = s.coeff();
+            have = true;
+        }
+        s.next();
+        if (s.valid())
+            std::push_heap(heap.begin(), heap.end(), after);
+        else
+            heap.pop_back();
+    }
+    if (have && !IsZero(acc))
+        sink(cur.data(), acc);
+}
+
+// Merge in-memory runs straight into a MultiPoly, freeing each run once
+// consumed, so the runs and the result are never duplicated
+MultiPoly<Fq> mergeRuns(std::vector<Run> &runs, size_t m, int d)
+{
+    std::vector<RunCursor> src(runs.begin(), runs.end());
+    MultiPoly<Fq> P(m, d);
+    mergeInto(src, d, [&P, m, d](const std::uint32_t *t, const Fq &c) {
+        MultiPoly<Fq>::Exponents e(m, 0);
+        for (int s = 0; s < d && t[s] != kEmpty; s++)
+            e[t[s]]++;
+        P.appendSorted(std::move(e), c);
+    });
+    return P;
+}
+
+bool isBlank(char ch) { return ch == ' ' || ch == '\t' || ch == '\r'; }
+
+const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && isBlank(*p))
+        p++;
+    return p;
+}
+
+// Text of the line starting at p, for error messages
+std::string lineAt(const char *p, const char *end)
+{
+    const char *q = std::find(p, end, '\n');
+    return std::string(p, std::min<size_t>(q - p, 80));
+}
+
+// Decimal integer mod q at p; advances p past it
+bool parseCoeff(Fq &c, const char *&p, const char *end)
+{
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    c = Fq(0);
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        // Up to 18 digits at a time in a long
+        long chunk = 0, scale = 1;
+        for (int k = 0; k < 18 && p < end && *p >= '0' && *p <= '9'; k++, p++)
+        {
+            chunk = chunk * 10 + (*p - '0');
+            scale *= 10;
+        }
+        c *= scale;
+        c += chunk;
+    }
+    if (neg)
+        c = Fq(0) - c;
+    return true;
+}
+
+// Parse the terms between p and end, which start and end on line boundaries
+void parseChunk(Run &run, const char *p, const char *end, size_t m)
+{
+    int d = run.d;
+    std::vector<std::uint32_t> vars(d);
+    Fq c;
+    while (p < end)
+    {
+        const char *line = p;
+        p = skipBlanks(p, end);
+        if (p == end || *p == '\n' || *p == '#')
+        {
+            p = std::find(p, end, '\n');
+            if (p < end)
+                p++;
+            continue;
+        }
+        if (!parseCoeff(c, p, end))
+            throw std::runtime_error("Malformed coefficient in term: " + lineAt(line, end));
+        int r = 0;
+        while (true)
+        {
+            const char *q = skipBlanks(p, end);
+            if (q == end || *q == '\n')
+            {
+                p = q < end ? q + 1 : q;
+                break;
+            }
+            if (q == p || *q < '0' || *q > '9')
+                throw std::runtime_error("Malformed variable list in term: " + lineAt(line, end));
+            std::uint64_t v = 0;
+            for (p = q; p < end && *p >= '0' && *p <= '9'; p++)
+            {
+                v = v * 10 + (*p - '0');
+                if (v >= m)
+                    throw std::out_of_range("Term refers to a missing variable: " + lineAt(line, end));
+            }
+            if (r == d)
+                throw std::out_of_range("Monomial total degree exceeds d: " + lineAt(line, end));
+            vars[r++] = static_cast<std::uint32_t>(v);
+        }
+        std::sort(vars.begin(), vars.begin() + r);
+        std::fill(vars.begin() + r, vars.end(), kEmpty);
+        run.slots.insert(run.slots.end(), vars.begin(), vars.end());
+        run.coeffs.push_back(c);
+    }
+}
+
+// Skip the header "m d", after any comment lines, and return where the terms start
+const char *parseHeader(const char *p, const char *end, size_t &m, int &d, const std::string &path)
+{
+    long mm = -1, dd = -1;
+    while (p < end && mm < 0)
+    {
+        const char *line = p;
+        const char *eol = std::find(p, end, '\n');
+        p = skipBlanks(p, eol);
+        if (p < eol && *p != '#')
+        {
+            std::string head(p, eol);
+            if (std::sscanf(head.c_str(), "%ld %ld", &mm, &dd) != 2 || mm <= 0 || dd < 0)
+                throw std::runtime_error("Malformed header line: " + lineAt(line, end));
+        }
+        p = eol < end ? eol + 1 : eol;
+    }
+    if (mm < 0)
+        throw std::runtime_error("Missing header line in " + path);
+    if (static_cast<std::uint64_t>(mm) >= kEmpty)
+        throw std::out_of_range("Too many variables for the text loader");
+    m = static_cast<size_t>(mm);
+    d = static_cast<int>(dd);
+    return p;
+}
+
+// Boundaries of `pieces` line-aligned chunks between p and end
+std::vector<const char *> cutLines(const char *p, const char *end, size_t pieces)
+{
+    std::vector<const char *> cut = {p};
+    for (size_t i = 1; i < pieces; i++)
+    {
+        const char *q = std::max(cut.back(), p + (end - p) * i / pieces);
+        q = std::find(q, end, '\n');
+        cut.push_back(q < end ? q + 1 : end);
+    }
+    cut.push_back(end);
+    return cut;
+}
+
+// Text per chunk when convertTextPoly spills sorted runs to disk
+constexpr size_t kSpillChunkBytes = size_t(64) << 20;
+} // namespace
+
+MultiPoly<Fq> loadTextPoly(const std::string &path, unsigned threads)
+{
+    MappedFile file(path);
+    const char *end = reinterpret_cast<const char *>(file.data()) + file.size();
+    size_t m;
+    int d;
+    const char *p = parseHeader(reinterpret_cast<const char *>(file.data()), end, m, d, path);
+
+    // Line-aligned chunks, a few per thread to even out the load
+    threads = std::max(1u, threads);
+    size_t pieces = threads == 1 ? 1 : 4 * threads;
+    std::vector<const char *> cut = cutLines(p, end, pieces);
+    std::vector<Run> runs(pieces);
+    parallelFor(pieces, threads, [&](size_t r) {
+        runs[r].d = d;
+        parseChunk(runs[r], cut[r], cut[r + 1], m);
+        sortRun(runs[r]);
+    });
+    return mergeRuns(runs, m, d);
+}
+
+void writeTextPoly(std::ostream &out, const MultiPoly<Fq> &P)
+{
+    out << P.varCount() << ' ' << P.maxDegree() << '\n';
+    for (const auto &[e, c] : P.terms())
+    {
+        out << c;
+        for (size_t v = 0; v < e.size(); v++)
+        {
+            for (int r = 0; r < e[v]; r++)
+                out << ' ' << v;
+        }
+        out << '\n';
+    }
+}
+
+MultiPoly<Fq> loadBinaryPoly(const std::string &path, size_t index, unsigned threads)
+{
+    MappedPoly M = MappedPoly::open(path, index);
+    size_t n = M.termCount();
+    int d = M.maxDegree();
+    if (M.varCount() >= kEmpty)
+        throw std::out_of_range("Too many variables for the binary loader");
+
+    threads = std::max(1u, threads);
+    size_t pieces = threads == 1 ? 1 : 4 * threads;
+    std::vector<Run> runs(pieces);
+    parallelFor(pieces, threads, [&](size_t r) {
+        size_t lo = n * r / pieces, hi = n * (r + 1) / pieces;
+        Run &run = runs[r];
+        run.d = d;
+        run.slots.resize((hi - lo) * d);
+        run.coeffs.resize(hi - lo);
+        for (size_t j = lo; j < hi; j++)
+        {
+            std::uint32_t *t = run.slots.data() + (j - lo) * d;
+            for (int s = 0; s < d; s++)
+            {
+                long v = M.slot(j, s);
+                if (v >= static_cast<long>(M.varCount()))
+                    throw std::runtime_error("Serialized monomial refers to a missing variable");
+                t[s] = v < 0 ? kEmpty : static_cast<std::uint32_t>(v);
+            }
+            std::sort(t, t + d);
+            M.coeff(run.coeffs[j - lo], j);
+        }
+        sortRun(run);
+    });
+    return mergeRuns(runs, M.varCount(), d);
+}
+
+void convertTextPoly(const std::string &textPath, const std::string &binPath, unsigned threads)
+{
+    MappedFile file(textPath);
+    const char *end = reinterpret_cast<const char *>(file.data()) + file.size();
+    size_t m;
+    int d;
+    const char *p = parseHeader(reinterpret_cast<const char *>(file.data()), end, m, d, textPath);
+
+    // Chunks of bounded size, each parsed, sorted and spilled before the
+    // worker takes the next, so at most `threads` runs are in memory
+    threads = std::max(1u, threads);
+    size_t pieces = std::max<size_t>(threads == 1 ? 1 : 4 * threads,
+                                     (end - p + kSpillChunkBytes - 1) / kSpillChunkBytes);
+    std::vector<const char *> cut = cutLines(p, end, pieces);
+    unsigned elemBytes = std::max<long>(1, NumBytes(ZZ_p::modulus()));
+    std::vector<SpilledRun> spilled(pieces);
+    parallelFor(pieces, threads, [&](size_t r) {
+        Run run;
+        run.d = d;
+        parseChunk(run, cut[r], cut[r + 1], m);
+        sortRun(run);
+        spilled[r].write(run, elemBytes);
+    });
+
+    // TermFileWriter needs the merged count up front, so merge twice
+    auto cursors = [&spilled]() { return std::vector<SpillCursor>(spilled.begin(), spilled.end()); };
+    std::vector<SpillCursor> src = cursors();
+    std::uint64_t count = 0;
+    mergeInto(src, d, [&count](const std::uint32_t *, const Fq &) { count++; });
+
+    src = cursors();
+    TermFileWriter out(binPath, m, d, count);
+    std::vector<size_t> vars;
+    mergeInto(src, d, [&](const std::uint32_t *t, const Fq &c) {
+        vars.clear();
+        for (int s = 0; s < d && t[s] != kEmpty; s++)
+            vars.push_back(t[s]);
+        out.addTerm(vars, c);
+    });
+    out.close();
+}
@@ -0,0 +1,603 @@
+#include "Serialize.h"
+#include "BinaryFormat.h"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace binfmt;
+
+namespace
+{
+void putLE(std::ostream &out, std::uint64_t v, unsigned n)
+{
+    unsigned char buf[8];
+    storeLE(buf, v, n);
+    out.write(reinterpret_cast<const char *>(buf), n);
+}
+
+std::uint64_t getLE(std::istream &in, unsigned n)
+{
+    unsigned char buf[8];
+    in.read(reinterpret_cast<char *>(buf), n);
+    if (!in)
+        throw std::runtime_error("Truncated binary stream");
+    return loadLE(buf, n);
+}
+
+void putPad(std::ostream &out, std::uint64_t bytes)
+{
+    static const char zeros[8] = {0};
+    out.write(zeros, padded(bytes) - bytes);
+}
+
+void skipPad(std::istream &in, std::uint64_t bytes)
+{
+    in.ignore(padded(bytes) - bytes);
+}
+
+void putZZ(std::ostream &out, const ZZ &x, unsigned width)
+{
+    if (sign(x) < 0)
+        throw std::invalid_argument("Cannot serialize a negative integer");
+    std::vector<unsigned char> buf(width);
+    BytesFromZZ(buf.data(), x, width);
+    out.write(reinterpret_cast<const char *>(buf.data()), width);
+}
+
+void getZZ(std::istream &in, ZZ &x, unsigned width)
+{
+    std::vector<unsigned char> buf(width);
+    in.read(reinterpret_cast<char *>(buf.data()), width);
+    if (!in)
+        throw std::runtime_error("Truncated binary stream");
+    ZZFromBytes(x, buf.data(), width);
+}
+
+unsigned zzBytes(const ZZ &x) { return std::max<long>(1, NumBytes(x)); }
+unsigned fieldBytes() { return zzBytes(ZZ_p::modulus()); }
+
+void putFq(std::ostream &out, const Fq &x, unsigned width) { putZZ(out, rep(x), width); }
+
+void getFq(std::istream &in, Fq &x, unsigned width)
+{
+    ZZ z;
+    getZZ(in, z, width);
+    conv(x, z);
+}
+
+void writeHeader(std::ostream &out, BinaryTag tag, unsigned elemBytes, std::uint64_t payload)
+{
+    putLE(out, static_cast<std::uint32_t>(tag), 4);
+    putLE(out, elemBytes, 4);
+    putLE(out, payload, 8);
+}
+
+SectionHeader readHeader(std::istream &in, BinaryTag expected)
+{
+    SectionHeader h;
+    h.tag = static_cast<std::uint32_t>(getLE(in, 4));
+    h.elemBytes = static_cast<std::uint32_t>(getLE(in, 4));
+    h.payloadBytes = getLE(in, 8);
+    if (h.tag != static_cast<std::uint32_t>(expected))
+        throw std::runtime_error("Unexpected section tag " + std::to_string(h.tag) +
+                                 ", expected " + std::to_string(static_cast<std::uint32_t>(expected)));
+    return h;
+}
+
+// Lengths come from the stream, so they are checked against the section's
+// payload before anything is allocated: count records of `each` bytes must
+// fit after the first `used` bytes.
+void checkLength(const SectionHeader &h, std::uint64_t used, std::uint64_t count, std::uint64_t each)
+{
+    if (used > h.payloadBytes || (each != 0 && count > (h.payloadBytes - used) / each))
+        throw std::runtime_error("Section length exceeds its payload");
+}
+
+// Fq sections begin with the modulus they were written under
+void checkModulus(std::istream &in, const SectionHeader &h)
+{
+    checkLength(h, 0, 1, h.elemBytes);
+    ZZ p;
+    getZZ(in, p, h.elemBytes);
+    if (p != ZZ_p::modulus())
+        throw std::runtime_error("Serialized field modulus does not match ZZ_p::modulus()");
+}
+
+void checkModulus(const unsigned char *p, unsigned width)
+{
+    ZZ q;
+    ZZFromBytes(q, p, width);
+    if (q != ZZ_p::modulus())
+        throw std::runtime_error("Serialized field modulus does not match ZZ_p::modulus()");
+}
+
+} // namespace
+
+void writeBinaryHeader(std::ostream &out)
+{
+    out.write(kMagic, sizeof(kMagic));
+    putLE(out, kBinaryVersion, 4);
+    putLE(out, 0, 4);
+}
+
+void readBinaryHeader(std::istream &in)
+{
+    char magic[8];
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, kMagic, sizeof(magic)) != 0)
+        throw std::runtime_error("Not an MSVC binary file");
+    std::uint32_t version = static_cast<std::uint32_t>(getLE(in, 4));
+    if (version != kBinaryVersion)
+        throw std::runtime_error("Unsupported binary format version " + std::to_string(version));
+    getLE(in, 4);
+}
+
+void writeBinary(std::ostream &out, const ZZ &x)
+{
+    unsigned w = zzBytes(x);
+    writeHeader(out, BinaryTag::ZZ, w, w);
+    putZZ(out, x, w);
+    putPad(out, w);
+}
+
+void readBinary(std::istream &in, ZZ &x)
+{
+    SectionHeader h = readHeader(in, BinaryTag::ZZ);
+    checkLength(h, 0, 1, h.elemBytes);
+    getZZ(in, x, h.elemBytes);
+    skipPad(in, h.payloadBytes);
+}
+
+void writeBinary(std::ostream &out, const Fq &x)
+{
+    unsigned w = fieldBytes();
+    writeHeader(out, BinaryTag::Fq, w, 2 * w);
+    putZZ(out, ZZ_p::modulus(), w);
+    putFq(out, x, w);
+    putPad(out, 2 * w);
+}
+
+void readBinary(std::istream &in, Fq &x)
+{
+    SectionHeader h = readHeader(in, BinaryTag::Fq);
+    checkModulus(in, h);
+    checkLength(h, h.elemBytes, 1, h.elemBytes);
+    getFq(in, x, h.elemBytes);
+    skipPad(in, h.payloadBytes);
+}
+
+void writeBinary(std::ostream &out, const Vec<ZZ> &v)
+{
+    unsigned w = 1;
+    for (long i = 0; i < v.length(); i++)
+        w = std::max(w, zzBytes(v[i]));
+    std::uint64_t payload = 8 + std::uint64_t(v.length()) * w;
+    writeHeader(out, BinaryTag::VecZZ, w, payload);
+    putLE(out, v.length(), 8);
+    for (long i = 0; i < v.length(); i++)
+        putZZ(out, v[i], w);
+    putPad(out, payload);
+}
+
+void readBinary(std::istream &in, Vec<ZZ> &v)
+{
+    SectionHeader h = readHeader(in, BinaryTag::VecZZ);
+    if (h.elemBytes == 0)
+        throw std::runtime_error("Malformed integer vector section");
+    std::uint64_t n = getLE(in, 8);
+    checkLength(h, 8, n, h.elemBytes);
+    v.SetLength(static_cast<long>(n));
+    for (long i = 0; i < v.length(); i++)
+        getZZ(in, v[i], h.elemBytes);
+    skipPad(in, h.payloadBytes);
+}
+
+void writeBinary(std::ostream &out, const Vec<Fq> &v)
+{
+    unsigned w = fieldBytes();
+    std::uint64_t payload = w + 8 + std::uint64_t(v.length()) * w;
+    writeHeader(out, BinaryTag::VecFq, w, payload);
+    putZZ(out, ZZ_p::modulus(), w);
+    putLE(out, v.length(), 8);
+    for (long i = 0; i < v.length(); i++)
+        putFq(out, v[i], w);
+    putPad(out, payload);
+}
+
+void readBinary(std::istream &in, Vec<Fq> &v)
+{
+    SectionHeader h = readHeader(in, BinaryTag::VecFq);
+    checkModulus(in, h);
+    std::uint64_t n = getLE(in, 8);
+    checkLength(h, h.elemBytes + 8, n, h.elemBytes);
+    v.SetLength(static_cast<long>(n));
+    for (long i = 0; i < v.length(); i++)
+        getFq(in, v[i], h.elemBytes);
+    skipPad(in, h.payloadBytes);
+}
+
+void writeBinary(std::ostream &out, const ZZ_pX &f)
+{
+    writeBinary(out, f.rep);
+}
+
+void readBinary(std::istream &in, ZZ_pX &f)
+{
+    readBinary(in, f.rep);
+    f.normalize();
+}
+
+void writeBinary(std::ostream &out, const PackedAffine &L)
+{
+    writeBinary(out, L.coeffs());
+}
+
+void readBinary(std::istream &in, PackedAffine &L)
+{
+    Vec<Fq> coeffs;
+    readBinary(in, coeffs);
+    if (coeffs.length() % 2 != 0)
+        throw std::runtime_error("Malformed affine key section");
+    L = PackedAffine(coeffs);
+}
+
+void writeBinary(std::ostream &out, const Mat<Fq> &M)
+{
+    unsigned w = fieldBytes();
+    std::uint64_t payload = w + 16 + std::uint64_t(M.NumRows()) * M.NumCols() * w;
+    writeHeader(out, BinaryTag::MatFq, w, payload);
+    putZZ(out, ZZ_p::modulus(), w);
+    putLE(out, M.NumRows(), 8);
+    putLE(out, M.NumCols(), 8);
+    for (long i = 0; i < M.NumRows(); i++)
+        for (long j = 0; j < M.NumCols(); j++)
+            putFq(out, M[i][j], w);
+    putPad(out, payload);
+}
+
+void readBinary(std::istream &in, Mat<Fq> &M)
+{
+    SectionHeader h = readHeader(in, BinaryTag::MatFq);
+    checkModulus(in, h);
+    std::uint64_t rows = getLE(in, 8);
+    std::uint64_t cols = getLE(in, 8);
+    checkLength(h, h.elemBytes + 16, cols, h.elemBytes);
+    checkLength(h, h.elemBytes + 16, rows, std::max<std::uint64_t>(cols, 1) * h.elemBytes);
+    M.SetDims(static_cast<long>(rows), static_cast<long>(cols));
+    for (long i = 0; i < M.NumRows(); i++)
+        for (long j = 0; j < M.NumCols(); j++)
+            getFq(in, M[i][j], h.elemBytes);
+    skipPad(in, h.payloadBytes);
+}
+
+void writeBinary(std::ostream &out, const MultiPoly<Fq> &P)
+{
+    unsigned w = fieldBytes();
+    unsigned sb = slotBytesFor(P.varCount());
+    int d = P.maxDegree();
+    std::uint64_t slotArea = std::uint64_t(P.termCount()) * d * sb;
+    std::uint64_t payload = w + kMultiPolyMetaBytes + padded(slotArea) + std::uint64_t(P.termCount()) * w;
+    writeHeader(out, BinaryTag::MultiPoly, w, payload);
+    putZZ(out, ZZ_p::modulus(), w);
+    putLE(out, P.varCount(), 8);
+    putLE(out, d, 4);
+    putLE(out, sb, 4);
+    putLE(out, P.termCount(), 8);
+
+    for (const auto &[e, c] : P.terms())
+    {
+        int used = 0;
+        for (size_t v = 0; v < e.size(); v++)
+            for (int r = 0; r < e[v]; r++, used++)
+                putLE(out, v, sb);
+        for (; used < d; used++)
+            putLE(out, sentinel(sb), sb);
+    }
+    putPad(out, slotArea);
+    for (const auto &[e, c] : P.terms())
+        putFq(out, c, w);
+    putPad(out, payload);
+}
+
+void readBinary(std::istream &in, MultiPoly<Fq> &P)
+{
+    SectionHeader h = readHeader(in, BinaryTag::MultiPoly);
+    checkModulus(in, h);
+    size_t m = static_cast<size_t>(getLE(in, 8));
+    int d = static_cast<int>(getLE(in, 4));
+    unsigned sb = static_cast<unsigned>(getLE(in, 4));
+    size_t terms = static_cast<size_t>(getLE(in, 8));
+    if (sb != 2 && sb != 4)
+        throw std::runtime_error("Unsupported exponent slot width");
+    if (m != 0 && sb != slotBytesFor(m))
+        throw std::runtime_error("Exponent slot width does not match the variable count");
+    if (d < 0)
+        throw std::runtime_error("Malformed MultiPoly section");
+    if (m == 0)
+    {
+        skipPad(in, h.payloadBytes);
+        P = MultiPoly<Fq>();
+        return;
+    }
+
+    std::uint64_t head = h.elemBytes + kMultiPolyMetaBytes;
+    checkLength(h, head, terms, std::uint64_t(d) * sb + h.elemBytes);
+    std::uint64_t slotArea = std::uint64_t(terms) * d * sb;
+    checkLength(h, head + padded(slotArea), terms, h.elemBytes);
+    std::vector<unsigned char> slots(slotArea);
+    in.read(reinterpret_cast<char *>(slots.data()), slotArea);
+    skipPad(in, slotArea);
+    if (!in)
+        throw std::runtime_error("Truncated binary stream");
+
+    MultiPoly<Fq> R(m, d);
+    MultiPoly<Fq>::Exponents e(m);
+    Fq c;
+    for (size_t j = 0; j < terms; j++)
+    {
+        std::fill(e.begin(), e.end(), 0);
+        for (int s = 0; s < d; s++)
+        {
+            std::uint64_t v = loadLE(&slots[(j * d + s) * sb], sb);
+            if (v == sentinel(sb))
+                break;
+            if (v >= m)
+                throw std::runtime_error("Serialized monomial refers to a missing variable");
+            e[v]++;
+        }
+        getFq(in, c, h.elemBytes);
+        R.addTerm(e, c);
+    }
+    skipPad(in, h.payloadBytes);
+    P = std::move(R);
+}
+
+void writeBinary(std::ostream &out, const Vec<MultiPoly<Fq>> &v)
+{
+    writeHeader(out, BinaryTag::PolyVec, 0, 8);
+    putLE(out, v.length(), 8);
+    for (long i = 0; i < v.length(); i++)
+        writeBinary(out, v[i]);
+}
+
+void readBinary(std::istream &in, Vec<MultiPoly<Fq>> &v)
+{
+    readHeader(in, BinaryTag::PolyVec);
+    // The polynomials are separate sections, so the count cannot be checked
+    // against this payload; grow as sections arrive instead
+    std::uint64_t n = getLE(in, 8);
+    v.SetLength(0);
+    MultiPoly<Fq> P;
+    for (std::uint64_t i = 0; i < n; i++)
+    {
+        readBinary(in, P);
+        v.append(P);
+    }
+}
+
+void writeBinary(std::ostream &out, const PreparedPoly<Fq> &P)
+{
+    unsigned w = fieldBytes();
+    std::uint64_t nodes = P.nodeCount(), terms = P.termCount();
+    std::uint64_t indexArea = (2 * nodes + terms) * 4;
+    std::uint64_t payload = w + 32 + padded(indexArea) + terms * w;
+    writeHeader(out, BinaryTag::PreparedPoly, w, payload);
+    putZZ(out, ZZ_p::modulus(), w);
+    putLE(out, P.varCount(), 8);
+    putLE(out, P.maxDegree(), 4);
+    putLE(out, 0, 4);
+    putLE(out, nodes, 8);
+    putLE(out, terms, 8);
+    for (auto n : P.parents())
+        putLE(out, n, 4);
+    for (auto v : P.vars())
+        putLE(out, v, 4);
+    for (auto n : P.termNodes())
+        putLE(out, n, 4);
+    putPad(out, indexArea);
+    for (const auto &c : P.termCoeffs())
+        putFq(out, c, w);
+    putPad(out, payload);
+}
+
+void readBinary(std::istream &in, PreparedPoly<Fq> &P)
+{
+    using Index = PreparedPoly<Fq>::Index;
+    SectionHeader h = readHeader(in, BinaryTag::PreparedPoly);
+    checkModulus(in, h);
+    size_t m = static_cast<size_t>(getLE(in, 8));
+    int d = static_cast<int>(getLE(in, 4));
+    getLE(in, 4);
+    std::uint64_t nodes = getLE(in, 8);
+    std::uint64_t terms = getLE(in, 8);
+    std::uint64_t head = h.elemBytes + 32;
+    checkLength(h, head, nodes, 8);
+    checkLength(h, head + 8 * nodes, terms, 4 + h.elemBytes);
+
+    std::vector<Index> parent(nodes), var(nodes), termNode(terms);
+    for (auto &n : parent)
+        n = static_cast<Index>(getLE(in, 4));
+    for (auto &v : var)
+        v = static_cast<Index>(getLE(in, 4));
+    for (auto &n : termNode)
+        n = static_cast<Index>(getLE(in, 4));
+    skipPad(in, (2 * std::uint64_t(nodes) + terms) * 4);
+
+    std::vector<Fq> coeffs(terms);
+    for (auto &c : coeffs)
+        getFq(in, c, h.elemBytes);
+    skipPad(in, h.payloadBytes);
+    P = PreparedPoly<Fq>(m, d, std::move(parent), std::move(var), std::move(termNode), std::move(coeffs));
+}
+
+void writeEvalKeyHeader(std::ostream &out, long k)
+{
+    writeHeader(out, BinaryTag::EvalKey, 0, 8);
+    putLE(out, k, 8);
+}
+
+long readEvalKeyHeader(std::istream &in)
+{
+    readHeader(in, BinaryTag::EvalKey);
+    return static_cast<long>(getLE(in, 8));
+}
+
+MappedFile::MappedFile(const std::string &path) : data_(nullptr), size_(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot map empty or unreadable file " + path);
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        throw std::runtime_error("mmap failed for " + path);
+    data_ = static_cast<const unsigned char *>(p);
+    size_ = static_cast<size_t>(st.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        munmap(const_cast<unsigned char *>(data_), size_);
+}
+
+std::vector<std::pair<SectionHeader, size_t>> listSections(const MappedFile &file)
+{
+    if (file.size() < kFileHeaderBytes || std::memcmp(file.data(), kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("Not an MSVC binary file");
+    if (loadLE(file.data() + 8, 4) != kBinaryVersion)
+        throw std::runtime_error("Unsupported binary format version");
+
+    std::vector<std::pair<SectionHeader, size_t>> sections;
+    size_t off = kFileHeaderBytes;
+    while (off + kSectionHeaderBytes <= file.size())
+    {
+        const unsigned char *p = file.data() + off;
+        SectionHeader h;
+        h.tag = static_cast<std::uint32_t>(loadLE(p, 4));
+        h.elemBytes = static_cast<std::uint32_t>(loadLE(p + 4, 4));
+        h.payloadBytes = loadLE(p + 8, 8);
+        if (h.payloadBytes > file.size() - off - kSectionHeaderBytes)
+            throw std::runtime_error("Section extends past end of file");
+        sections.emplace_back(h, off);
+        off += kSectionHeaderBytes + padded(h.payloadBytes);
+    }
+    return sections;
+}
+
+MappedPoly::MappedPoly(std::shared_ptr<const MappedFile> file, size_t sectionOffset)
+    : file_(std::move(file))
+{
+    if (sectionOffset + kSectionHeaderBytes > file_->size())
+        throw std::out_of_range("Section offset past end of file");
+    const unsigned char *p = file_->data() + sectionOffset;
+    if (loadLE(p, 4) != static_cast<std::uint32_t>(BinaryTag::MultiPoly))
+        throw std::runtime_error("Section is not a MultiPoly");
+    elemBytes_ = static_cast<unsigned>(loadLE(p + 4, 4));
+    std::uint64_t payload = loadLE(p + 8, 8);
+    if (payload > file_->size() - sectionOffset - kSectionHeaderBytes)
+        throw std::runtime_error("Section extends past end of file");
+
+    // Modulus and metadata must lie inside the payload before either is read
+    std::uint64_t head = std::uint64_t(elemBytes_) + kMultiPolyMetaBytes;
+    if (elemBytes_ == 0 || head > payload)
+        throw std::runtime_error("MultiPoly section is truncated");
+    p += kSectionHeaderBytes;
+    checkModulus(p, elemBytes_);
+    p += elemBytes_;
+    varCount_ = static_cast<size_t>(loadLE(p, 8));
+    maxDegree_ = static_cast<int>(loadLE(p + 8, 4));
+    slotBytes_ = static_cast<unsigned>(loadLE(p + 12, 4));
+    termCount_ = static_cast<size_t>(loadLE(p + 16, 8));
+    if (slotBytes_ != 2 && slotBytes_ != 4)
+        throw std::runtime_error("Unsupported exponent slot width");
+    std::uint64_t perTerm = std::uint64_t(maxDegree_) * slotBytes_ + elemBytes_;
+    if (maxDegree_ < 0 || termCount_ > (payload - head) / perTerm)
+        throw std::runtime_error("MultiPoly section is truncated");
+
+    std::uint64_t slotArea = std::uint64_t(termCount_) * maxDegree_ * slotBytes_;
+    if (head + padded(slotArea) + std::uint64_t(termCount_) * elemBytes_ > payload)
+        throw std::runtime_error("MultiPoly section is truncated");
+    slots_ = p + kMultiPolyMetaBytes;
+    coeffs_ = slots_ + padded(slotArea);
+}
+
+MappedPoly MappedPoly::open(const std::string &path, size_t index)
+{
+    auto file = std::make_shared<const MappedFile>(path);
+    for (const auto &[h, off] : listSections(*file))
+    {
+        if (h.tag != static_cast<std::uint32_t>(BinaryTag::MultiPoly))
+            continue;
+        if (index-- == 0)
+            return MappedPoly(file, off);
+    }
+    throw std::out_of_range("No such MultiPoly section in " + path);
+}
+
+long MappedPoly::slot(size_t j, int s) const
+{
+    std::uint64_t v = loadLE(slots_ + (j * maxDegree_ + s) * slotBytes_, slotBytes_);
+    return v == sentinel(slotBytes_) ? -1 : static_cast<long>(v);
+}
+
+void MappedPoly::coeff(Fq &c, size_t j) const
+{
+    ZZ z;
+    ZZFromBytes(z, coeffs_ + j * elemBytes_, elemBytes_);
+    conv(c, z);
+}
+
+Fq MappedPoly::evaluate(const std::vector<Fq> &pts) const
+{
+    if (pts.size() != varCount_)
+        throw std::invalid_argument("Evaluation point has wrong number of variables");
+    Fq sum, term;
+    for (size_t j = 0; j < termCount_; j++)
+    {
+        coeff(term, j);
+        for (int s = 0; s < maxDegree_; s++)
+        {
+            long v = slot(j, s);
+            if (v < 0)
+                break;
+            if (static_cast<size_t>(v) >= varCount_)
+                throw std::runtime_error("Serialized monomial refers to a missing variable");
+            term *= pts[v];
+        }
+        sum += term;
+    }
+    return sum;
+}
+
+MultiPoly<Fq> MappedPoly::load() const
+{
+    MultiPoly<Fq> R(varCount_, maxDegree_);
+    MultiPoly<Fq>::Exponents e(varCount_);
+    Fq c;
+    for (size_t j = 0; j < termCount_; j++)
+    {
+        std::fill(e.begin(), e.end(), 0);
+        for (int s = 0; s < maxDegree_; s++)
+        {
+            long v = slot(j, s);
+            if (v < 0)
+                break;
+            if (static_cast<size_t>(v) >= varCount_)
+                throw std::runtime_error("Serialized monomial refers to a missing variable");
+            e[v]++;
+        }
+        coeff(c, j);
+        R.addTerm(e, c);
+    }
+    return R;
+}
@@ -0,0 +1,161 @@
+#include "StragglerSim.h"
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+double LatencyModel::sample(std::mt19937_64 &rng) const
+{
+    switch (kind)
+    {
+    case Constant:
+        return base;
+    case Exponential:
+        return base + std::exponential_distribution<double>(1.0 / scale)(rng);
+    case LogNormal:
+        return base + std::lognormal_distribution<double>(std::log(scale), shape)(rng);
+    case Pareto:
+    {
+        // Inverse CDF: x_m / U^(1/alpha)
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return base + scale / std::pow(1.0 - u, 1.0 / shape);
+    }
+    }
+    return base;
+}
+
+LatencyModel LatencyModel::parse(const std::string &spec)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(spec);
+    std::string part;
+    while (std::getline(ss, part, ':'))
+    {
+        parts.push_back(part);
+    }
+    if (parts.empty())
+        throw std::invalid_argument("Empty latency model");
+
+    std::vector<double> v;
+    for (size_t i = 1; i < parts.size(); ++i)
+    {
+        v.push_back(std::stod(parts[i]));
+    }
+
+    LatencyModel model;
+    const std::string &name = parts[0];
+    if (name == "const" && v.size() == 1)
+    {
+        model.kind = Constant;
+    }
+    else if (name == "exp" && v.size() == 2 && v[1] > 0)
+    {
+        model.kind = Exponential;
+    }
+    else if (name == "lognormal" && v.size() == 3 && v[1] > 0 && v[2] >= 0)
+    {
+        model.kind = LogNormal;
+    }
+    else if (name == "pareto" && v.size() == 3 && v[1] > 0 && v[2] > 0)
+    {
+        model.kind = Pareto;
+    }
+    else
+    {
+        throw std::invalid_argument("Invalid latency model: " + spec);
+    }
+    model.base = v[0];
+    model.scale = v.size() > 1 ? v[1] : 0;
+    model.shape = v.size() > 2 ? v[2] : 0;
+    return model;
+}
+
+std::vector<LatencyModel> LatencyModel::parseList(const std::string &specs)
+{
+    std::vector<LatencyModel> models;
+    std::stringstream ss(specs);
+    std::string spec;
+    while (std::getline(ss, spec, ','))
+    {
+        models.push_back(parse(spec));
+    }
+    if (models.empty())
+        throw std::invalid_argument("Empty latency model list");
+    return models;
+}
+
+std::string LatencyModel::toString() const
+{
+    std::stringstream ss;
+    switch (kind)
+    {
+    case Constant:
+        ss << "const:" << base;
+        break;
+    case Exponential:
+        ss << "exp:" << base << ":" << scale;
+        break;
+    case LogNormal:
+        ss << "lognormal:" << base << ":" << scale << ":" << shape;
+        break;
+    case Pareto:
+        ss << "pareto:" << base << ":" << scale << ":" << shape;
+        break;
+    }
+    return ss.str();
+}
+
+StragglerSim::StragglerSim(const std::vector<LatencyModel> &models, long n, uint64_t seed)
+    : rng_(seed)
+{
+    if (models.empty() || n <= 0)
+        throw std::invalid_argument("StragglerSim needs at least one server");
+    models_.reserve(n);
+    for (long i = 0; i < n; ++i)
+    {
+        models_.push_back(models[i % models.size()]);
+    }
+}
+
+void StragglerSim::arrivals(std::vector<double> &arrival, const std::vector<double> &compute_ms)
+{
+    if ((long)compute_ms.size() != servers())
+        throw std::invalid_argument("One compute time per server is required");
+
+    arrival.resize(compute_ms.size());
+    for (size_t i = 0; i < compute_ms.size(); ++i)
+    {
+        arrival[i] = compute_ms[i] + models_[i].sample(rng_);
+    }
+}
+
+double StragglerSim::firstK(Vec<long> &idx, const std::vector<double> &arrival, long k)
+{
+    long n = arrival.size();
+    if (k <= 0 || k > n)
+        throw std::invalid_argument("k must be between 1 and the number of servers");
+
+    // Only the k fastest need ordering; ties go to the lower index
+    std::vector<long> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                      [&arrival](long a, long b)
+                      { return arrival[a] < arrival[b] || (arrival[a] == arrival[b] && a < b); });
+
+    idx.SetLength(k);
+    for (long r = 0; r < k; ++r)
+    {
+        idx[r] = order[r];
+    }
+    return arrival[order[k - 1]];
+}
+
+double StragglerSim::percentile(std::vector<double> v, double p)
+{
+    if (v.empty())
+        return 0;
+    long rank = (long)std::ceil(p / 100.0 * v.size());
+    rank = std::min<long>(std::max<long>(rank, 1), v.size());
+    std::nth_element(v.begin(), v.begin() + rank - 1, v.end());
+    return v[rank - 1];
+}
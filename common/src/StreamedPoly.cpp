@@ -0,0 +1,329 @@
+#include "StreamedPoly.h"
+#include "BinaryFormat.h"
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace binfmt;
+
+namespace
+{
+const std::uint32_t kMultiPolyTag = static_cast<std::uint32_t>(BinaryTag::MultiPoly);
+
+void writeAll(int fd, const unsigned char *p, size_t n, std::uint64_t off)
+{
+    while (n > 0)
+    {
+        ssize_t r = pwrite(fd, p, n, static_cast<off_t>(off));
+        if (r <= 0)
+            throw std::runtime_error("Write to term file failed");
+        p += r;
+        n -= static_cast<size_t>(r);
+        off += static_cast<std::uint64_t>(r);
+    }
+}
+
+void readAll(int fd, unsigned char *p, size_t n, std::uint64_t off)
+{
+    while (n > 0)
+    {
+        ssize_t r = pread(fd, p, n, static_cast<off_t>(off));
+        if (r <= 0)
+            throw std::runtime_error("Truncated term file");
+        p += r;
+        n -= static_cast<size_t>(r);
+        off += static_cast<std::uint64_t>(r);
+    }
+}
+} // namespace
+
+TermFileWriter::TermFileWriter(const std::string &path, size_t m, int d, std::uint64_t termCount,
+                               size_t chunkTerms)
+    : fd_(-1), m_(m), d_(d), termCount_(termCount), chunkTerms_(std::max<size_t>(1, chunkTerms))
+{
+    if (d < 0)
+        throw std::invalid_argument("Degree must be non-negative");
+    const ZZ &p = ZZ_p::modulus();
+    elemBytes_ = std::max<long>(1, NumBytes(p));
+    slotBytes_ = slotBytesFor(m);
+
+    std::uint64_t slotArea = termCount * d * slotBytes_;
+    std::uint64_t payload = elemBytes_ + kMultiPolyMetaBytes + padded(slotArea) + termCount * elemBytes_;
+    slotsPos_ = kFileHeaderBytes + kSectionHeaderBytes + elemBytes_ + kMultiPolyMetaBytes;
+    coeffsPos_ = slotsPos_ + padded(slotArea);
+    endPos_ = kFileHeaderBytes + kSectionHeaderBytes + padded(payload);
+
+    std::vector<unsigned char> head(slotsPos_, 0);
+    std::memcpy(head.data(), kMagic, sizeof(kMagic));
+    storeLE(&head[8], kBinaryVersion, 4);
+    storeLE(&head[16], kMultiPolyTag, 4);
+    storeLE(&head[20], elemBytes_, 4);
+    storeLE(&head[24], payload, 8);
+    BytesFromZZ(&head[32], p, elemBytes_);
+    unsigned char *meta = &head[32 + elemBytes_];
+    storeLE(meta, m, 8);
+    storeLE(meta + 8, d, 4);
+    storeLE(meta + 12, slotBytes_, 4);
+    storeLE(meta + 16, termCount, 8);
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        throw std::runtime_error("Cannot create " + path);
+    try
+    {
+        writeAll(fd_, head.data(), head.size(), 0);
+        // Padding between regions stays zero; the file may be sparse until filled
+        if (ftruncate(fd_, static_cast<off_t>(endPos_)) != 0)
+            throw std::runtime_error("Cannot size term file " + path);
+    }
+    catch (...)
+    {
+        ::close(fd_);
+        throw;
+    }
+}
+
+TermFileWriter::~TermFileWriter()
+{
+    if (fd_ < 0)
+        return;
+    // Keep every term that was added even without close(); errors cannot
+    // propagate from here
+    try
+    {
+        flush();
+    }
+    catch (const std::exception &)
+    {
+    }
+    ::close(fd_);
+}
+
+void TermFileWriter::addTerm(const MultiPoly<Fq>::Exponents &e, const Fq &c)
+{
+    if (e.size() != m_)
+        throw std::invalid_argument("Exponent vector has wrong number of variables");
+    std::vector<size_t> vars;
+    for (size_t v = 0; v < e.size(); v++)
+        for (int r = 0; r < e[v]; r++)
+            vars.push_back(v);
+    addTerm(vars, c);
+}
+
+void TermFileWriter::addTerm(const std::vector<size_t> &vars, const Fq &c)
+{
+    if (fd_ < 0)
+        throw std::logic_error("Term file is already closed");
+    if (written_ == termCount_)
+        throw std::out_of_range("More terms than announced for term file");
+    if (vars.size() > static_cast<size_t>(d_))
+        throw std::invalid_argument("Term degree exceeds the maximum degree");
+    for (size_t s = 0; s < vars.size(); s++)
+        if (vars[s] >= m_ || (s > 0 && vars[s] < vars[s - 1]))
+            throw std::invalid_argument("Variable indices must be ascending and < varCount");
+
+    size_t at = slots_.size();
+    slots_.resize(at + size_t(d_) * slotBytes_);
+    for (int s = 0; s < d_; s++)
+        storeLE(&slots_[at + size_t(s) * slotBytes_],
+                s < static_cast<int>(vars.size()) ? vars[s] : sentinel(slotBytes_), slotBytes_);
+
+    at = coeffs_.size();
+    coeffs_.resize(at + elemBytes_);
+    BytesFromZZ(&coeffs_[at], rep(c), elemBytes_);
+
+    if (++written_ - flushed_ == chunkTerms_)
+        flush();
+}
+
+void TermFileWriter::flush()
+{
+    writeAll(fd_, slots_.data(), slots_.size(), slotsPos_ + flushed_ * d_ * slotBytes_);
+    writeAll(fd_, coeffs_.data(), coeffs_.size(), coeffsPos_ + flushed_ * elemBytes_);
+    flushed_ = written_;
+    slots_.clear();
+    coeffs_.clear();
+}
+
+void TermFileWriter::close()
+{
+    if (fd_ < 0)
+        return;
+    flush();
+    if (written_ != termCount_)
+        throw std::runtime_error("Term file closed after " + std::to_string(written_) +
+                                 " of " + std::to_string(termCount_) + " terms");
+    int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) != 0)
+        throw std::runtime_error("Closing term file failed");
+}
+
+std::uint64_t fullTermCount(size_t m, int d)
+{
+    // C(m+d, d) = prod_{i=1..d} (m+i)/i, exact at every step
+    std::uint64_t n = 1;
+    for (int i = 1; i <= d; i++)
+    {
+        if (n > UINT64_MAX / (m + i))
+            throw std::overflow_error("Term count does not fit in 64 bits");
+        n = n * (m + i) / i;
+    }
+    return n;
+}
+
+void writeFullPoly(const std::string &path, size_t m, int d,
+                   const std::function<Fq()> &coeff, size_t chunkTerms)
+{
+    TermFileWriter out(path, m, d, fullTermCount(m, d), chunkTerms);
+    std::vector<size_t> vars;
+    out.addTerm(vars, coeff());
+    if (m == 0)
+    {
+        out.close();
+        return;
+    }
+    // All non-decreasing index sequences of each length r, in lexicographic order
+    for (int r = 1; r <= d; r++)
+    {
+        vars.assign(r, 0);
+        while (true)
+        {
+            out.addTerm(vars, coeff());
+            int s = r - 1;
+            while (s >= 0 && vars[s] == m - 1)
+                s--;
+            if (s < 0)
+                break;
+            vars[s]++;
+            std::fill(vars.begin() + s + 1, vars.end(), vars[s]);
+        }
+    }
+    out.close();
+}
+
+StreamedPoly::StreamedPoly(const std::string &path, size_t index, size_t chunkTerms)
+    : chunkTerms_(std::max<size_t>(1, chunkTerms))
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Cannot open " + path);
+    fd_ = std::shared_ptr<const int>(new int(fd), [](const int *p) {
+        ::close(*p);
+        delete p;
+    });
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        throw std::runtime_error("Cannot stat " + path);
+    std::uint64_t size = static_cast<std::uint64_t>(st.st_size);
+
+    unsigned char buf[kSectionHeaderBytes];
+    if (size < kFileHeaderBytes)
+        throw std::runtime_error("Not an MSVC binary file");
+    readAll(fd, buf, kFileHeaderBytes, 0);
+    if (std::memcmp(buf, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("Not an MSVC binary file");
+    if (loadLE(buf + 8, 4) != kBinaryVersion)
+        throw std::runtime_error("Unsupported binary format version");
+
+    // Walk section headers to the index-th MultiPoly
+    std::uint64_t off = kFileHeaderBytes, payload = 0;
+    while (true)
+    {
+        if (off + kSectionHeaderBytes > size)
+            throw std::out_of_range("No such MultiPoly section in " + path);
+        readAll(fd, buf, kSectionHeaderBytes, off);
+        payload = loadLE(buf + 8, 8);
+        if (payload > size - off - kSectionHeaderBytes)
+            throw std::runtime_error("Section extends past end of file");
+        if (loadLE(buf, 4) == kMultiPolyTag && index-- == 0)
+            break;
+        off += kSectionHeaderBytes + padded(payload);
+    }
+    elemBytes_ = static_cast<unsigned>(loadLE(buf + 4, 4));
+
+    std::vector<unsigned char> meta(elemBytes_ + kMultiPolyMetaBytes);
+    if (meta.size() > payload)
+        throw std::runtime_error("MultiPoly section is truncated");
+    readAll(fd, meta.data(), meta.size(), off + kSectionHeaderBytes);
+    ZZ q;
+    ZZFromBytes(q, meta.data(), elemBytes_);
+    if (q != ZZ_p::modulus())
+        throw std::runtime_error("Serialized field modulus does not match ZZ_p::modulus()");
+    const unsigned char *p = meta.data() + elemBytes_;
+    varCount_ = static_cast<size_t>(loadLE(p, 8));
+    maxDegree_ = static_cast<int>(loadLE(p + 8, 4));
+    slotBytes_ = static_cast<unsigned>(loadLE(p + 12, 4));
+    termCount_ = static_cast<size_t>(loadLE(p + 16, 8));
+    if (slotBytes_ != 2 && slotBytes_ != 4)
+        throw std::runtime_error("Unsupported exponent slot width");
+
+    std::uint64_t slotArea = std::uint64_t(termCount_) * maxDegree_ * slotBytes_;
+    if (meta.size() + padded(slotArea) + std::uint64_t(termCount_) * elemBytes_ > payload)
+        throw std::runtime_error("MultiPoly section is truncated");
+    slotsPos_ = off + kSectionHeaderBytes + meta.size();
+    coeffsPos_ = slotsPos_ + padded(slotArea);
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+void StreamedPoly::read(Chunk &chunk, size_t first) const
+{
+    chunk.count = std::min(chunkTerms_, termCount_ - first);
+    size_t slotStride = size_t(maxDegree_) * slotBytes_;
+    chunk.slots.resize(chunk.count * slotStride);
+    chunk.coeffs.resize(chunk.count * elemBytes_);
+    readAll(*fd_, chunk.slots.data(), chunk.slots.size(), slotsPos_ + std::uint64_t(first) * slotStride);
+    readAll(*fd_, chunk.coeffs.data(), chunk.coeffs.size(), coeffsPos_ + std::uint64_t(first) * elemBytes_);
+}
+
+Fq StreamedPoly::evaluate(const std::vector<Fq> &pts) const
+{
+    if (pts.size() != varCount_)
+        throw std::invalid_argument("Evaluation point has wrong number of variables");
+    Fq sum, term;
+    if (termCount_ == 0)
+        return sum;
+
+    const std::uint64_t empty = sentinel(slotBytes_);
+    Chunk cur, next;
+    ZZ z;
+    read(cur, 0);
+    for (size_t first = 0; first < termCount_; first += chunkTerms_)
+    {
+        // Read the following chunk while this one is accumulated
+        std::future<void> pending;
+        if (first + chunkTerms_ < termCount_)
+            pending = std::async(std::launch::async, [this, &next, first] {
+                read(next, first + chunkTerms_);
+            });
+
+        const unsigned char *slot = cur.slots.data();
+        for (size_t j = 0; j < cur.count; j++)
+        {
+            ZZFromBytes(z, cur.coeffs.data() + j * elemBytes_, elemBytes_);
+            conv(term, z);
+            for (int s = 0; s < maxDegree_; s++, slot += slotBytes_)
+            {
+                std::uint64_t v = loadLE(slot, slotBytes_);
+                if (v == empty)
+                    continue;
+                if (v >= varCount_)
+                    throw std::runtime_error("Serialized monomial refers to a missing variable");
+                term *= pts[v];
+            }
+            sum += term;
+        }
+
+        if (pending.valid())
+        {
+            pending.get();
+            std::swap(cur, next);
+        }
+    }
+    return sum;
+}
@@ -0,0 +1,218 @@
+#include "Workload.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+WorkloadSpec WorkloadSpec::parse(const std::string &spec)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(spec);
+    std::string part;
+    while (std::getline(ss, part, ':'))
+    {
+        parts.push_back(part);
+    }
+
+    WorkloadSpec w;
+    if (parts.size() == 1 && parts[0] == "full")
+    {
+        return w;
+    }
+    if (parts.size() < 2 || parts.size() > 6 || parts[0] != "sparse")
+        throw std::invalid_argument("Unknown workload: " + spec);
+
+    w.kind = Sparse;
+    w.terms = std::stol(parts[1]);
+    if (parts.size() > 2)
+        w.density = std::stod(parts[2]);
+    if (parts.size() > 3)
+    {
+        if (parts[3] == "uniform")
+            w.degree = Uniform;
+        else if (parts[3] == "top")
+            w.degree = Top;
+        else if (parts[3] == "geom")
+            w.degree = Geometric;
+        else
+            throw std::invalid_argument("Unknown degree distribution: " + parts[3]);
+    }
+    if (parts.size() > 4)
+    {
+        if (parts[4] == "random")
+            w.coeff = Random;
+        else if (parts[4] == "small")
+            w.coeff = Small;
+        else if (parts[4] == "one")
+            w.coeff = One;
+        else
+            throw std::invalid_argument("Unknown coefficient distribution: " + parts[4]);
+    }
+    if (parts.size() > 5)
+        w.seed = std::stoull(parts[5]);
+
+    if (w.terms <= 0 || !(w.density > 0 && w.density <= 1))
+        throw std::invalid_argument("Invalid workload parameters: " + spec);
+    return w;
+}
+
+std::string WorkloadSpec::toString() const
+{
+    if (kind == Full)
+        return "full";
+    static const char *degName[] = {"uniform", "top", "geom"};
+    static const char *coeffName[] = {"random", "small", "one"};
+    std::ostringstream out;
+    out << "sparse:" << terms << ":" << density << ":" << degName[degree] << ":"
+        << coeffName[coeff] << ":" << seed;
+    return out.str();
+}
+
+Fq randomFq(std::mt19937_64 &rng)
+{
+    // 64 bits beyond the modulus keep the bias below 2^-64
+    long words = (NumBits(ZZ_p::modulus()) + 64 + 31) / 32;
+    Fq r(0);
+    for (long i = 0; i < words; i++)
+    {
+        r *= (1L << 32);
+        r += to_ZZ_p(static_cast<long>(rng() >> 32));
+    }
+    return r;
+}
+
+static Fq drawCoeff(const WorkloadSpec &spec, std::mt19937_64 &rng)
+{
+    switch (spec.coeff)
+    {
+    case WorkloadSpec::Small:
+        return to_ZZ_p(static_cast<long>(rng() % 65536) + 1);
+    case WorkloadSpec::One:
+        return to_ZZ_p(1);
+    case WorkloadSpec::Random:
+        break;
+    }
+    Fq c;
+    do
+    {
+        c = randomFq(rng);
+    } while (IsZero(c));
+    return c;
+}
+
+static int drawDegree(const WorkloadSpec &spec, int d, std::mt19937_64 &rng)
+{
+    switch (spec.degree)
+    {
+    case WorkloadSpec::Top:
+        return d;
+    case WorkloadSpec::Geometric:
+    {
+        int j = d;
+        while (j > 0 && (rng() & 1))
+            j--;
+        return j;
+    }
+    case WorkloadSpec::Uniform:
+        break;
+    }
+    return static_cast<int>(rng() % (d + 1));
+}
+
+// Adds the missing terms of F by sampling without replacement among all
+// monomials of degree lowest..d over the active variables that F lacks.
+// Degrees then follow the monomial counts rather than spec.degree.
+static void fillDistinct(MultiPoly<Fq> &F, const WorkloadSpec &spec, const std::vector<size_t> &active,
+                         int lowest, int d, std::mt19937_64 &rng)
+{
+    MultiPoly<Fq>::Exponents e(F.varCount(), 0);
+    std::vector<std::vector<int>> avail;
+    for (MonomialEnumerator it(active.size(), d); !it.done(); ++it)
+    {
+        if (it.degree() < lowest)
+            continue;
+        for (size_t k = 0; k < active.size(); k++)
+            e[active[k]] = (*it)[k];
+        if (!F.terms().count(e))
+            avail.push_back(*it);
+    }
+    // Partial Fisher-Yates: the first `need` entries are a uniform sample
+    size_t need = spec.terms - F.termCount();
+    for (size_t t = 0; t < need; t++)
+    {
+        size_t r = t + rng() % (avail.size() - t);
+        std::swap(avail[t], avail[r]);
+        for (size_t k = 0; k < active.size(); k++)
+            e[active[k]] = avail[t][k];
+        F.addTerm(e, drawCoeff(spec, rng));
+    }
+}
+
+MultiPoly<Fq> generateWorkload(const WorkloadSpec &spec, size_t m, int d)
+{
+    if (spec.kind == WorkloadSpec::Full)
+    {
+        std::mt19937_64 rng(spec.seed);
+        return generateFullPoly(m, d, randomFq(rng));
+    }
+
+    std::mt19937_64 rng(spec.seed);
+
+    // Active variables
+    std::vector<size_t> active;
+    std::bernoulli_distribution keep(spec.density);
+    for (size_t i = 0; i < m; i++)
+    {
+        if (keep(rng))
+            active.push_back(i);
+    }
+    if (active.empty())
+        active.push_back(rng() % m);
+
+    // Degree d monomials over the active variables bound what can be drawn
+    int lowest = spec.degree == WorkloadSpec::Top ? d : 0;
+    uint64_t room = MonomialEnumerator::count(active.size(), d);
+    if (lowest > 0)
+        room -= MonomialEnumerator::count(active.size(), lowest - 1);
+    if (static_cast<uint64_t>(spec.terms) > room)
+        throw std::invalid_argument("Workload asks for more terms than its monomials allow");
+
+    MultiPoly<Fq> F(m, d);
+    MultiPoly<Fq>::Exponents e(m);
+    // Rejection only while misses stay rare: when terms is a large fraction
+    // of room, or the draws keep hitting saturated degrees, the remainder
+    // comes from fillDistinct
+    long misses = 0;
+    bool dense = 2 * static_cast<uint64_t>(spec.terms) > room;
+    while (!dense && static_cast<long>(F.termCount()) < spec.terms)
+    {
+        std::fill(e.begin(), e.end(), 0);
+        int j = drawDegree(spec, d, rng);
+        for (int s = 0; s < j; s++)
+            e[active[rng() % active.size()]]++;
+        if (F.terms().count(e))
+        {
+            dense = ++misses > 10 * spec.terms + 1000;
+            continue;
+        }
+        F.addTerm(e, drawCoeff(spec, rng));
+    }
+    if (dense)
+        fillDistinct(F, spec, active, lowest, d, rng);
+    return F;
+}
+
+Vec<Fq> generateWorkloadInput(const WorkloadSpec &spec, long m)
+{
+    if (spec.kind == WorkloadSpec::Full)
+        return generateSimpleInput(m);
+
+    // A separate stream, so X does not depend on how many draws F took
+    std::mt19937_64 rng(spec.seed ^ 0x9e3779b97f4a7c15ULL);
+    Vec<Fq> X;
+    X.SetLength(m);
+    for (long i = 0; i < m; i++)
+    {
+        X[i] = randomFq(rng);
+    }
+    return X;
+}
@@ -64,6 +64,558 @@ ZZ compute_g_fa(const ZZ_pX &f,
     return result;
 }
 
+FixedBaseExp::FixedBaseExp(const ZZ &g, const ZZ &mod, long maxBits, long window)
+    : g_(g), mod_(mod), maxBits_(maxBits), window_(window)
+{
+    if (window < 1 || window > 16)
+        throw std::invalid_argument("FixedBaseExp window must be in [1, 16]");
+    if (maxBits < 1)
+        throw std::invalid_argument("FixedBaseExp needs a positive exponent bound");
+
+    long windows = (maxBits + window - 1) / window;
+    long size = 1L << window;
+    table_.resize(windows);
+    ZZ base = g % mod;
+    for (long i = 0; i < windows; ++i)
+    {
+        table_[i].resize(size);
+        table_[i][0] = 1;
+        for (long j = 1; j < size; ++j)
+            MulMod(table_[i][j], table_[i][j - 1], base, mod);
+        // base becomes g^(2^((i+1)*window))
+        for (long s = 0; s < window; ++s)
+            SqrMod(base, base, mod);
+    }
+}
+
+void FixedBaseExp::power(ZZ &x, const ZZ &e) const
+{
+    if (sign(e) < 0 || NumBits(e) > maxBits_)
+    {
+        PowerMod(x, g_, e, mod_);
+        return;
+    }
+    x = 1;
+    long bits = NumBits(e);
+    for (long i = 0, pos = 0; pos < bits; ++i, pos += window_)
+    {
+        long digit = 0;
+        for (long s = window_ - 1; s >= 0; --s)
+            digit = (digit << 1) | bit(e, pos + s);
+        if (digit != 0)
+            MulMod(x, x, table_[i][digit], mod_);
+    }
+}
+
+long FixedBaseExp::bestWindow(long maxBits, long uses)
+{
+    long best = 1;
+    double bestCost = -1;
+    for (long w = 1; w <= 12; ++w)
+    {
+        double windows = static_cast<double>((maxBits + w - 1) / w);
+        double cost = windows * ((1L << w) - 1 + w) + uses * windows;
+        if (bestCost < 0 || cost < bestCost)
+        {
+            best = w;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+void Vandermonde(Mat<Fq> &V, long points, long cols)
+{
+    V.SetDims(points, cols);
+    for (long i = 0; i < points; ++i)
+    {
+        Fq x = to_ZZ_p(i), p(1);
+        for (long j = 0; j < cols; ++j)
+        {
+            V[i][j] = p;
+            p *= x;
+        }
+    }
+}
+
+void BatchInverse(Vec<Fq> &x, const Vec<Fq> &a)
+{
+    long n = a.length();
+    Vec<Fq> prefix;
+    prefix.SetLength(n);
+    Fq acc(1);
+    for (long i = 0; i < n; ++i)
+    {
+        prefix[i] = acc;
+        acc *= a[i];
+    }
+    if (n > 0 && IsZero(acc))
+        throw std::invalid_argument("BatchInverse of a zero element");
+    acc = inv(acc);
+    x.SetLength(n);
+    for (long i = n - 1; i >= 0; --i)
+    {
+        Fq ai = a[i];
+        x[i] = acc * prefix[i];
+        acc *= ai;
+    }
+}
+
+void LagrangeWeights(Vec<Fq> &w, const Vec<Fq> &pts, const Fq &x)
+{
+    long k = pts.length();
+    w.SetLength(k);
+    if (k == 0)
+        return;
+
+    // Numerators prod_{j != i} (x - pts[j]) from prefix and suffix products
+    Vec<Fq> diff, suffix, denom;
+    diff.SetLength(k);
+    suffix.SetLength(k + 1);
+    denom.SetLength(k);
+    for (long j = 0; j < k; ++j)
+        sub(diff[j], x, pts[j]);
+    set(suffix[k]);
+    for (long j = k - 1; j >= 0; --j)
+        mul(suffix[j], suffix[j + 1], diff[j]);
+
+    Fq prefix(1), tmp;
+    for (long i = 0; i < k; ++i)
+    {
+        mul(w[i], prefix, suffix[i + 1]);
+        mul(prefix, prefix, diff[i]);
+
+        set(denom[i]);
+        for (long j = 0; j < k; ++j)
+        {
+            if (j == i)
+                continue;
+            sub(tmp, pts[i], pts[j]);
+            mul(denom[i], denom[i], tmp);
+        }
+    }
+    BatchInverse(denom, denom);
+    for (long i = 0; i < k; ++i)
+        mul(w[i], w[i], denom[i]);
+}
+
+void ShareWeights(Vec<Fq> &w, long k, const Fq &x)
+{
+    w.SetLength(k);
+    if (k == 0)
+        return;
+
+    Vec<Fq> diff, suffix, fact, denom;
+    diff.SetLength(k);
+    suffix.SetLength(k + 1);
+    fact.SetLength(k);
+    denom.SetLength(k);
+    set(fact[0]);
+    for (long j = 0; j < k; ++j)
+    {
+        sub(diff[j], x, to_ZZ_p(j));
+        if (j > 0)
+            mul(fact[j], fact[j - 1], to_ZZ_p(j));
+    }
+    set(suffix[k]);
+    for (long j = k - 1; j >= 0; --j)
+        mul(suffix[j], suffix[j + 1], diff[j]);
+
+    Fq prefix(1);
+    for (long i = 0; i < k; ++i)
+    {
+        mul(w[i], prefix, suffix[i + 1]);
+        mul(prefix, prefix, diff[i]);
+        mul(denom[i], fact[i], fact[k - 1 - i]);
+        if ((k - 1 - i) % 2 != 0)
+            denom[i] = -denom[i];
+    }
+    BatchInverse(denom, denom);
+    for (long i = 0; i < k; ++i)
+        mul(w[i], w[i], denom[i]);
+}
+
+void ResponderPoints(Vec<Fq> &pts, const Vec<long> &idx, long k, long n)
+{
+    if (idx.length() < k)
+        throw std::invalid_argument("Fewer responses than the k the protocol needs");
+
+    std::vector<bool> seen(n, false);
+    pts.SetLength(k);
+    for (long r = 0; r < k; ++r)
+    {
+        if (idx[r] < 0 || idx[r] >= n)
+            throw std::out_of_range("Responder index out of range");
+        if (seen[idx[r]])
+            throw std::invalid_argument("Duplicate responder index");
+        seen[idx[r]] = true;
+        pts[r] = to_ZZ_p(idx[r]);
+    }
+}
+
+void SystemShape(long &m, int &d, const Vec<MultiPoly<Fq>> &F)
+{
+    if (F.length() == 0)
+        throw std::invalid_argument("F needs at least one output polynomial");
+
+    m = F[0].varCount();
+    d = F[0].maxDegree();
+    for (long j = 0; j < F.length(); ++j)
+    {
+        if (F[j].varCount() == 0 || F[j].maxDegree() < 0)
+            throw std::invalid_argument("Invalid polynomial F");
+        if (static_cast<long>(F[j].varCount()) != m)
+            throw std::invalid_argument("Every output of F must have the same variables");
+        d = std::max(d, F[j].maxDegree());
+    }
+}
+
+void EvaluateAll(std::vector<Fq> &out, const Vec<MultiPoly<Fq>> &F, const std::vector<Fq> &pts)
+{
+    out.resize(F.length());
+    for (long j = 0; j < F.length(); ++j)
+    {
+        out[j] = F[j].evaluate(pts);
+    }
+}
+
+bool DecodeRS(ZZ_pX &f, Vec<long> &bad, const Vec<Fq> &pts, const Vec<Fq> &vals, long dim)
+{
+    long n = pts.length();
+    if (vals.length() != n)
+        throw std::invalid_argument("DecodeRS needs one value per point");
+    if (dim < 1 || dim > n)
+        throw std::invalid_argument("Code dimension must be in [1, n]");
+
+    // Partial extended Euclid on g0 = prod (x - pts[i]) and the interpolant
+    // g1, tracking v with r1 = u * g0 + v * g1, until deg r1 < (n + dim) / 2
+    ZZ_pX r0, r1, v0, v1, q, r;
+    BuildFromRoots(r0, pts);
+    interpolate(r1, pts, vals);
+    SetCoeff(v1, 0);
+    while (2 * deg(r1) >= n + dim)
+    {
+        DivRem(q, r, r0, r1);
+        r0 = r1;
+        r1 = r;
+        r = v0 - q * v1;
+        v0 = v1;
+        v1 = r;
+    }
+
+    // v1 is the error locator; f = r1 / v1 must divide exactly
+    DivRem(f, r, r1, v1);
+    if (!IsZero(r) || deg(f) >= dim)
+        return false;
+
+    bad.SetLength(0);
+    Fq y;
+    for (long i = 0; i < n; ++i)
+    {
+        eval(y, f, pts[i]);
+        if (y != vals[i])
+            bad.append(i);
+    }
+    return 2 * bad.length() <= n - dim;
+}
+
+bool DecodeResponses(Vec<Fq> &at0, Vec<long> &bad, const Mat<Fq> &pi, const Vec<long> &idx,
+                     const Vec<long> &dims, long n)
+{
+    long rows = pi.NumRows();
+    if (idx.length() != rows || dims.length() != pi.NumCols())
+        throw std::invalid_argument("DecodeResponses needs one index per row and one dimension per column");
+
+    Vec<Fq> pts, col;
+    ResponderPoints(pts, idx, rows, n);
+    col.SetLength(rows);
+    at0.SetLength(dims.length());
+    std::vector<bool> faulty(rows, false);
+    ZZ_pX f;
+    Vec<long> wrong;
+    for (long j = 0; j < dims.length(); ++j)
+    {
+        for (long r = 0; r < rows; ++r)
+            col[r] = pi[r][j];
+        if (!DecodeRS(f, wrong, pts, col, dims[j]))
+            return false;
+        at0[j] = coeff(f, 0);
+        for (long e = 0; e < wrong.length(); ++e)
+            faulty[wrong[e]] = true;
+    }
+
+    std::vector<long> servers;
+    for (long r = 0; r < rows; ++r)
+    {
+        if (faulty[r])
+            servers.push_back(idx[r]);
+    }
+    std::sort(servers.begin(), servers.end());
+    bad.SetLength(servers.size());
+    for (size_t e = 0; e < servers.size(); ++e)
+        bad[e] = servers[e];
+    return true;
+}
+
+bool DecodeResponse(ZZ_pX &phi, Vec<long> &bad, const Vec<Fq> &pi, const Vec<long> &idx, long dim, long n)
+{
+    if (idx.length() != pi.length())
+        throw std::invalid_argument("DecodeResponse needs one index per response");
+
+    Vec<Fq> pts;
+    ResponderPoints(pts, idx, pi.length(), n);
+    Vec<long> wrong;
+    if (!DecodeRS(phi, wrong, pts, pi, dim))
+        return false;
+
+    std::vector<long> servers;
+    for (long e = 0; e < wrong.length(); ++e)
+        servers.push_back(idx[wrong[e]]);
+    std::sort(servers.begin(), servers.end());
+    bad.SetLength(servers.size());
+    for (size_t e = 0; e < servers.size(); ++e)
+        bad[e] = servers[e];
+    return true;
+}
+
+ZZ MultiExp(const Vec<ZZ> &bases, const Vec<ZZ> &exps, const ZZ &mod)
+{
+    long n = bases.length();
+    if (exps.length() != n)
+        throw std::invalid_argument("MultiExp needs one exponent per base");
+
+    long bits = 0;
+    for (long i = 0; i < n; ++i)
+    {
+        if (sign(exps[i]) < 0)
+            throw std::invalid_argument("MultiExp exponents must be non-negative");
+        bits = std::max(bits, NumBits(exps[i]));
+    }
+
+    ZZ result(1);
+    if (n < 4)
+    {
+        ZZ x;
+        for (long i = 0; i < n; ++i)
+        {
+            PowerMod(x, bases[i], exps[i], mod);
+            MulMod(result, result, x, mod);
+        }
+        return result;
+    }
+
+    // Each window costs n bucket fills plus about 2^(c+1) products to sum them
+    long c = 1;
+    double best = -1;
+    for (long w = 1; w <= 16; ++w)
+    {
+        double cost = static_cast<double>((bits + w - 1) / w) * (n + (2L << w));
+        if (best < 0 || cost < best)
+        {
+            best = cost;
+            c = w;
+        }
+    }
+
+    long windows = (bits + c - 1) / c;
+    long size = 1L << c;
+    std::vector<ZZ> bucket(size);
+    std::vector<char> used(size);
+    ZZ acc, sum;
+    for (long win = windows - 1; win >= 0; --win)
+    {
+        for (long s = 0; s < c; ++s)
+            SqrMod(result, result, mod);
+
+        std::fill(used.begin(), used.end(), 0);
+        for (long i = 0; i < n; ++i)
+        {
+            long digit = 0;
+            for (long s = c - 1; s >= 0; --s)
+                digit = (digit << 1) | bit(exps[i], win * c + s);
+            if (digit == 0)
+                continue;
+            if (used[digit])
+                MulMod(bucket[digit], bucket[digit], bases[i], mod);
+            else
+            {
+                bucket[digit] = bases[i] % mod;
+                used[digit] = 1;
+            }
+        }
+
+        // sum = prod_j bucket[j]^j via running products from the top bucket down
+        bool any = false;
+        for (long j = size - 1; j >= 1; --j)
+        {
+            if (used[j])
+            {
+                if (any)
+                    MulMod(acc, acc, bucket[j], mod);
+                else
+                {
+                    acc = bucket[j];
+                    sum = 1;
+                    any = true;
+                }
+            }
+            if (any)
+                MulMod(sum, sum, acc, mod);
+        }
+        if (any)
+            MulMod(result, result, sum, mod);
+    }
+    return result;
+}
+
+void InterpolationMatrix(Mat<Fq> &M, long points)
+{
+    Vec<Fq> k_vec, e;
+    k_vec.SetLength(points);
+    e.SetLength(points);
+    for (long i = 0; i < points; ++i)
+        k_vec[i] = to_ZZ_p(i);
+
+    // Column j holds the coefficients of the interpolant of the j-th unit vector
+    M.SetDims(points, points);
+    ZZ_pX f;
+    for (long j = 0; j < points; ++j)
+    {
+        clear(e);
+        set(e[j]);
+        interpolate(f, k_vec, e);
+        for (long i = 0; i <= deg(f); ++i)
+            M[i][j] = coeff(f, i);
+    }
+}
+
+// Check instances [lo, hi) together; bisect on failure
+static bool BatchProductCheckRange(std::vector<bool> &ok, const ZZ &g, const Vec<ZZ> &gExp,
+                                   const Vec<Vec<ZZ>> &bases, const Vec<Vec<ZZ>> &exps,
+                                   const ZZ &ord, const ZZ &mod, long secbits, long lo, long hi)
+{
+    bool single = hi - lo == 1;
+    long total = 1;
+    for (long n = lo; n < hi; ++n)
+        total += bases[n].length();
+
+    // g^(sum s_n gExp_n) * prod_{n,j} bases[n][j]^(s_n exps[n][j]) == 1
+    Vec<ZZ> B, E;
+    B.SetLength(total);
+    E.SetLength(total);
+    B[0] = g;
+    E[0] = 0;
+    ZZ s(1);
+    long at = 1;
+    for (long n = lo; n < hi; ++n)
+    {
+        if (!single)
+        {
+            do
+            {
+                RandomBits(s, secbits);
+            } while (IsZero(s));
+        }
+        E[0] = (E[0] + s * gExp[n]) % ord;
+        for (long j = 0; j < bases[n].length(); ++j, ++at)
+        {
+            B[at] = bases[n][j];
+            E[at] = (s * exps[n][j]) % ord;
+        }
+    }
+    if (IsOne(MultiExp(B, E, mod)))
+    {
+        for (long n = lo; n < hi; ++n)
+            ok[n] = true;
+        return true;
+    }
+    if (single)
+        return false;
+
+    long mid = lo + (hi - lo) / 2;
+    bool a = BatchProductCheckRange(ok, g, gExp, bases, exps, ord, mod, secbits, lo, mid);
+    bool b = BatchProductCheckRange(ok, g, gExp, bases, exps, ord, mod, secbits, mid, hi);
+    return a && b;
+}
+
+bool BatchProductCheck(std::vector<bool> &ok, const ZZ &g, const Vec<ZZ> &gExp,
+                       const Vec<Vec<ZZ>> &bases, const Vec<Vec<ZZ>> &exps,
+                       const ZZ &ord, const ZZ &mod, long secbits)
+{
+    long n = gExp.length();
+    if (bases.length() != n || exps.length() != n)
+        throw std::invalid_argument("BatchProductCheck needs matching instance vectors");
+    for (long i = 0; i < n; ++i)
+    {
+        if (bases[i].length() != exps[i].length())
+            throw std::invalid_argument("BatchProductCheck needs one exponent per base");
+    }
+    ok.assign(n, false);
+    if (n == 0)
+        return true;
+    return BatchProductCheckRange(ok, g, gExp, bases, exps, ord, mod, secbits, 0, n);
+}
+
+bool FoldedPowerCheck(Vec<Fq> &phi0, const Mat<Fq> &pi, const Vec<ZZ> &gPows, const Vec<ZZ> &target,
+                      const ZZ &g, const ZZ &mod, long secbits)
+{
+    long k = pi.NumRows();
+    long r = pi.NumCols();
+    if (target.length() != r)
+        throw std::invalid_argument("FoldedPowerCheck needs one target per column");
+    if (gPows.length() < k - 1)
+        throw std::invalid_argument("FoldedPowerCheck needs k - 1 powers of alpha");
+
+    // Coefficients of every phi_j at once
+    Mat<Fq> M, Phi;
+    InterpolationMatrix(M, k);
+    mul(Phi, M, pi);
+
+    Vec<ZZ> rho;
+    Vec<Fq> rho_p;
+    rho.SetLength(r);
+    rho_p.SetLength(r);
+    phi0.SetLength(r);
+    for (long j = 0; j < r; ++j)
+    {
+        RandomBits(rho[j], secbits);
+        conv(rho_p[j], rho[j]);
+        phi0[j] = Phi[0][j];
+    }
+
+    // sum_j rho_j phi_j must meet prod_j target_j^rho_j
+    ZZ_pX phi;
+    Fq c;
+    for (long i = 0; i < k; ++i)
+    {
+        InnerProduct(c, Phi[i], rho_p);
+        SetCoeff(phi, i, c);
+    }
+    return compute_g_fa(phi, gPows, g, mod) == MultiExp(target, rho, mod);
+}
+
+bool BatchExpCheck(std::vector<bool> &ok, const ZZ &g, const Vec<ZZ> &h,
+                   const Vec<ZZ> &u, const Vec<ZZ> &v,
+                   const ZZ &ord, const ZZ &mod, long secbits)
+{
+    long n = h.length();
+    if (u.length() != n || v.length() != n)
+        throw std::invalid_argument("BatchExpCheck needs matching instance vectors");
+
+    // g^u == h^v  <=>  g^u * h^(ord - v) == 1
+    Vec<Vec<ZZ>> bases, exps;
+    bases.SetLength(n);
+    exps.SetLength(n);
+    for (long i = 0; i < n; ++i)
+    {
+        bases[i].SetLength(1);
+        exps[i].SetLength(1);
+        bases[i][0] = h[i];
+        exps[i][0] = (ord - v[i] % ord) % ord;
+    }
+    return BatchProductCheck(ok, g, u, bases, exps, ord, mod, secbits);
+}
+
 ZZ FindGen(const ZZ& p, const ZZ& q, long max_trials) {
     ZZ a, leg, g;
     for (long trials = 0; trials < max_trials; trials++) {
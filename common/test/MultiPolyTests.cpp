@@ -2,8 +2,31 @@
 // Comprehensive tests for MultiPoly class and associated free functions
 
 #include "MultiPoly.h"
+#include "EvalKey.h"
+#include "PreparedPoly.h"
+#include "Serialize.h"
+#include "StreamedPoly.h"
+#include "PrecomputePool.h"
+#include "PackedAffine.h"
+#include "StragglerSim.h"
+#include "IncrementalEvaluator.h"
+#include "QuadraticPoly.h"
+#include "LinearForms.h"
+#include "Circuit.h"
+#include "Workload.h"
+#include "PolyLoader.h"
+#include "MSVC_RH_5_packed.h"
+#include "MSVC_RH_5.h"
+#include "MSVC_SP_4.h"
+#include "MSVC_RH_4.h"
+#include "MSVC_SP_5.h"
+#include "MSVC_CH_5.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 // Utility to print test header
@@ -99,6 +122,1839 @@ void testCompose() {
     assert(eval == 55);
 }
 
+void testEvalKey() {
+    printHeader("Test EvalKey");
+    auto F = generateFullPoly<int>(3, 2);
+    auto ek = EvalKey<MultiPoly<int>>::share(F, 4);
+    std::cout << "Servers = " << ek.length() << ", shared owners = " << ek.useCount() << '\n';
+    assert(ek.length() == 4);
+    // Every server sees the same polynomial object, not a copy
+    assert(&ek[0] == &ek[3]);
+    assert(ek[2].termCount() == F.termCount());
+    auto view = ek.view(1);
+    assert(ek.useCount() == 2);
+    assert(view->evaluate({1, 2, 3}) == F.evaluate({1, 2, 3}));
+    bool threw = false;
+    try { ek[4]; } catch (const std::out_of_range &) { threw = true; }
+    assert(threw);
+
+    // modify() copies while a view is outstanding, and patches in place once it is gone
+    ek.modify([](MultiPoly<int> &P) { P.addTerm({1, 0, 0}, 5); });
+    assert(view->evaluate({1, 2, 3}) == F.evaluate({1, 2, 3}));
+    assert(ek[0].evaluate({1, 2, 3}) == F.evaluate({1, 2, 3}) + 5);
+    view.reset();
+    const MultiPoly<int> *before = &ek[0];
+    ek.modify([](MultiPoly<int> &P) { P.addTerm({1, 0, 0}, -5); });
+    assert(&ek[0] == before);
+    assert(ek[3].evaluate({1, 2, 3}) == F.evaluate({1, 2, 3}));
+}
+
+void testPreparedPoly() {
+    printHeader("Test PreparedPoly");
+    // Sparse polynomial whose monomials do not all share prefixes
+    MultiPoly<int> P(3,3);
+    P.addTerm({0,0,0}, 7);
+    P.addTerm({0,0,3}, 2);
+    P.addTerm({1,1,1}, -4);
+    P.addTerm({2,0,1}, 5);
+    PreparedPoly<int> Q(P);
+    std::cout << "Terms = " << Q.termCount() << ", DAG nodes = " << Q.nodeCount() << '\n';
+    assert(Q.termCount() == P.termCount());
+    assert(Q.evaluate({2,3,5}) == P.evaluate({2,3,5}));
+    assert(Q.evaluate({0,0,0}) == 7);
+
+    auto F = generateFullPoly<int>(4, 3, 3);
+    PreparedPoly<int> G(F);
+    // Every monomial of a full polynomial is its own DAG node
+    assert(G.nodeCount() == F.termCount());
+    assert(G.evaluate({1,-2,3,2}) == F.evaluate({1,-2,3,2}));
+}
+
+void testSerialization() {
+    printHeader("Test binary serialization");
+    ZZ_p::init(ZZ(1000003));
+    MultiPoly<ZZ_p> F = generateFullPoly<ZZ_p>(4, 3, to_ZZ_p(5));
+    F.addTerm({1,0,2,0}, to_ZZ_p(11));
+    Mat<ZZ_p> sigma = random_mat_ZZ_p(3, 4);
+    Vec<ZZ> group;
+    group.SetLength(2);
+    group[0] = 7;
+    group[1] = ZZ(1) << 70;
+    auto ek = EvalKey<PreparedPoly<ZZ_p>>::share(PreparedPoly<ZZ_p>(F), 5);
+    ZZ_pX f;
+    SetCoeff(f, 0, 4);
+    SetCoeff(f, 3, 9);
+
+    const char *path = "multipoly_test.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        writeBinaryHeader(out);
+        writeBinary(out, F);
+        writeBinary(out, sigma);
+        writeBinary(out, group);
+        writeBinary(out, ek);
+        writeBinary(out, f);
+    }
+
+    MultiPoly<ZZ_p> G;
+    Mat<ZZ_p> sigma2;
+    Vec<ZZ> group2;
+    EvalKey<PreparedPoly<ZZ_p>> ek2;
+    ZZ_pX f2;
+    {
+        std::ifstream in(path, std::ios::binary);
+        readBinaryHeader(in);
+        readBinary(in, G);
+        readBinary(in, sigma2);
+        readBinary(in, group2);
+        readBinary(in, ek2);
+        readBinary(in, f2);
+    }
+    std::vector<ZZ_p> pt = {to_ZZ_p(3), to_ZZ_p(-1), to_ZZ_p(8), to_ZZ_p(123)};
+    assert(G.termCount() == F.termCount());
+    assert(G.evaluate(pt) == F.evaluate(pt));
+    assert(sigma2 == sigma);
+    assert(group2 == group);
+    assert(ek2.length() == 5);
+    assert(ek2[4].evaluate(pt) == F.evaluate(pt));
+    assert(f2 == f && deg(f2) == 3);
+
+    // Evaluate in place from the mapped file
+    MappedPoly M = MappedPoly::open(path);
+    std::cout << "Mapped terms = " << M.termCount() << '\n';
+    assert(M.termCount() == F.termCount());
+    assert(M.evaluate(pt) == F.evaluate(pt));
+    assert(M.load().evaluate(pt) == F.evaluate(pt));
+    std::remove(path);
+
+    // A corrupted length must be rejected before it is allocated
+    auto corrupt = [](const std::string &bytes, size_t at) {
+        std::string s = bytes;
+        for (size_t i = 0; i < 6; i++)
+            s[at + i] = '\xFF';
+        return std::istringstream(s);
+    };
+    unsigned w = NumBytes(ZZ_p::modulus());
+    std::ostringstream vs, ms;
+    writeBinary(vs, sigma[0]);
+    writeBinary(ms, sigma);
+    bool threw = false;
+    try { auto in = corrupt(vs.str(), 16 + w); Vec<ZZ_p> v; readBinary(in, v); }
+    catch (const std::runtime_error &) { threw = true; }
+    assert(threw);
+    for (size_t at : {size_t(16 + w), size_t(24 + w)})
+    {
+        threw = false;
+        try { auto in = corrupt(ms.str(), at); Mat<ZZ_p> M2; readBinary(in, M2); }
+        catch (const std::runtime_error &) { threw = true; }
+        assert(threw);
+    }
+
+    // Scalar sections: a huge element width against a small payload
+    std::ostringstream zs, fs;
+    writeBinary(zs, group[1]);
+    writeBinary(fs, sigma[0][0]);
+    threw = false;
+    try { auto in = corrupt(zs.str(), 4); ZZ z; readBinary(in, z); }
+    catch (const std::runtime_error &) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { auto in = corrupt(fs.str(), 4); ZZ_p x; readBinary(in, x); }
+    catch (const std::runtime_error &) { threw = true; }
+    assert(threw);
+
+    // Mapped MultiPoly whose header claims more than the file holds: a huge
+    // element width, and a payload too short for the modulus and metadata
+    std::ostringstream ps;
+    writeBinaryHeader(ps);
+    writeBinary(ps, F);
+    std::string wide = ps.str(), shortened = ps.str();
+    for (size_t i = 0; i < 3; i++)
+        wide[16 + 4 + i] = '\xFF';
+    shortened[16 + 8] = 8;
+    for (size_t i = 1; i < 8; i++)
+        shortened[16 + 8 + i] = 0;
+    shortened.resize(16 + 16 + 8);
+    for (const std::string &bytes : {wide, shortened})
+    {
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(bytes.data(), bytes.size());
+        }
+        threw = false;
+        try { MappedPoly::open(path); }
+        catch (const std::runtime_error &) { threw = true; }
+        assert(threw);
+    }
+    std::remove(path);
+
+    // SP4's public VK_X round-trips without its trapdoors a and alpha
+    SP4::Env env;
+    SP4::Initialize(env, 1, 128);
+    auto H = generateFullPoly<Fq>(3, 2, to_ZZ_p(4));
+    SP4::PK_F pk;
+    SP4::VK_F vk_f;
+    SP4::EK_F ekH;
+    SP4::KeyGen(pk, vk_f, ekH, env, H);
+    Vec<Fq> X = random_vec_ZZ_p(env.m), pi;
+    SP4::VK_X vk_x, vk_x2;
+    Mat<Fq> sigmaH;
+    SP4::ProbGen(vk_x, sigmaH, env, pk, X);
+    std::stringstream vks, pub;
+    SP4::writeBinary(vks, vk_x);
+    writeBinary(pub, vk_x.gfa);
+    writeBinary(pub, vk_x.alpha);
+    assert(vks.str() == pub.str());
+    SP4::readBinary(vks, vk_x2);
+    assert(IsZero(vk_x2.a_bk) && IsZero(vk_x2.alpha_bk));
+    pi.SetLength(env.k);
+    for (int i = 0; i < env.k; i++)
+        SP4::Compute(pi[i], i, ekH[i], sigmaH[i], env);
+    Fq res;
+    assert(SP4::Verify(res, vk_f, vk_x2, pi, env));
+    assert(res == H.evaluate(std::vector<Fq>(X.begin(), X.end())));
+}
+
+void testStreamedPoly() {
+    printHeader("Test streamed evaluation");
+    ZZ_p::init(ZZ(1000003));
+    const size_t m = 6;
+    const int d = 3;
+    assert(fullTermCount(m, d) == 84);
+
+    // Stream a complete polynomial with coefficients 1, 2, 3, ...
+    const char *path = "streamed_test.bin";
+    long next = 0;
+    writeFullPoly(path, m, d, [&next] { return to_ZZ_p(++next); }, 10);
+
+    MultiPoly<ZZ_p> F = MappedPoly::open(path).load();
+    assert(F.termCount() == 84);
+    std::vector<ZZ_p> pt = {to_ZZ_p(2), to_ZZ_p(7), to_ZZ_p(-3), to_ZZ_p(11), to_ZZ_p(0), to_ZZ_p(5)};
+
+    // Chunk sizes that divide, do not divide and exceed the term count
+    for (size_t chunk : {1, 7, 84, 1000})
+    {
+        StreamedPoly S(path, 0, chunk);
+        assert(S.termCount() == 84 && S.varCount() == m && S.maxDegree() == d);
+        assert(S.evaluate(pt) == F.evaluate(pt));
+    }
+
+    // Term-by-term writer agrees with writeBinary
+    {
+        TermFileWriter out(path, m, d, F.termCount(), 16);
+        for (const auto &[e, c] : F.terms())
+            out.addTerm(e, c);
+        out.close();
+    }
+    std::cout << "Streamed value = " << StreamedPoly(path).evaluate(pt) << '\n';
+    assert(StreamedPoly(path).evaluate(pt) == F.evaluate(pt));
+    auto fileBytes = [](const char *p) {
+        std::ifstream in(p, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+    std::ostringstream ref;
+    writeBinaryHeader(ref);
+    writeBinary(ref, F);
+    assert(fileBytes(path) == ref.str());
+
+    // Terms still buffered when the writer goes out of scope are flushed
+    {
+        TermFileWriter out(path, m, d, F.termCount(), 1000);
+        for (const auto &[e, c] : F.terms())
+            out.addTerm(e, c);
+    }
+    assert(fileBytes(path) == ref.str());
+    std::remove(path);
+}
+
+void testBatchHelpers() {
+    printHeader("Test batch helpers");
+    ZZ q(1019), p(2039); // p = 2q + 1
+    ZZ_p::init(q);
+    ZZ g(4);
+
+    // Fixed-base exponentiation agrees with PowerMod, including past maxBits
+    for (long w : {1, 3, 5})
+    {
+        FixedBaseExp gexp(g, p, NumBits(q), w);
+        for (long e : {0L, 1L, 2L, 77L, 1018L, 5000L})
+        {
+            assert(gexp.power(ZZ(e)) == PowerMod(g, ZZ(e), p));
+        }
+    }
+    assert(FixedBaseExp::bestWindow(128, 1) < FixedBaseExp::bestWindow(128, 100000));
+
+    Mat<ZZ_p> V;
+    Vandermonde(V, 4, 3);
+    assert(V[0][0] == 1 && V[0][1] == 0 && V[3][2] == 9);
+
+    Vec<ZZ_p> a, x;
+    a.SetLength(5);
+    for (long i = 0; i < 5; i++)
+        a[i] = to_ZZ_p(3 * i + 2);
+    BatchInverse(x, a);
+    for (long i = 0; i < 5; i++)
+        assert(x[i] * a[i] == 1);
+    BatchInverse(a, a); // in place
+    assert(a == x);
+    std::cout << "Batch helpers OK\n";
+}
+
+void testMultiExp() {
+    printHeader("Test multi-exponentiation and batch checks");
+    ZZ q(1019), p(2039); // p = 2q + 1, 4 generates the order-q subgroup
+    ZZ_p::init(q);
+    ZZ g(4);
+
+    for (long n : {0, 1, 3, 4, 37, 200})
+    {
+        Vec<ZZ> bases, exps;
+        bases.SetLength(n);
+        exps.SetLength(n);
+        ZZ expect(1);
+        for (long i = 0; i < n; i++)
+        {
+            bases[i] = PowerMod(g, ZZ(i + 3), p);
+            exps[i] = ZZ((i * 7919) % 1019);
+            expect = MulMod(expect, PowerMod(bases[i], exps[i], p), p);
+        }
+        assert(MultiExp(bases, exps, p) == expect);
+    }
+
+    // g^u == h^v with h = g^alpha, i.e. u = alpha * v; corrupt two instances
+    const long N = 50;
+    Vec<ZZ> h, u, v;
+    h.SetLength(N);
+    u.SetLength(N);
+    v.SetLength(N);
+    for (long n = 0; n < N; n++)
+    {
+        ZZ alpha(n + 2);
+        h[n] = PowerMod(g, alpha, p);
+        v[n] = ZZ(3 * n + 1);
+        u[n] = (alpha * v[n]) % q;
+    }
+    std::vector<bool> ok;
+    assert(BatchExpCheck(ok, g, h, u, v, q, p));
+    u[5] = (u[5] + 1) % q;
+    u[41] = (u[41] + 1) % q;
+    assert(!BatchExpCheck(ok, g, h, u, v, q, p));
+    for (long n = 0; n < N; n++)
+        assert(ok[n] == (n != 5 && n != 41));
+
+    // Weights at 0 for points 0..3 reproduce f(0)
+    Vec<ZZ_p> pts, w;
+    pts.SetLength(4);
+    for (long i = 0; i < 4; i++)
+        pts[i] = to_ZZ_p(i + 1);
+    LagrangeWeights(w, pts, ZZ_p());
+    ZZ_p f0; // f(x) = 5 + 2x + x^3
+    for (long i = 0; i < 4; i++)
+        f0 += w[i] * (5 + 2 * pts[i] + pts[i] * pts[i] * pts[i]);
+    assert(f0 == 5);
+
+    // Closed-form weights for the share points match the generic ones
+    Vec<ZZ_p> sharePts, ws;
+    sharePts.SetLength(6);
+    for (long i = 0; i < 6; i++)
+        sharePts[i] = to_ZZ_p(i);
+    for (long x : {0, 3, 17})
+    {
+        LagrangeWeights(w, sharePts, to_ZZ_p(x));
+        ShareWeights(ws, 6, to_ZZ_p(x));
+        assert(w == ws);
+    }
+
+    // Interpolation matrix recovers coefficients from values at 0..3
+    Mat<ZZ_p> M;
+    InterpolationMatrix(M, 4);
+    Vec<ZZ_p> y, c;
+    y.SetLength(4);
+    for (long i = 0; i < 4; i++)
+        y[i] = 5 + 2 * to_ZZ_p(i) + to_ZZ_p(i * i * i);
+    mul(c, M, y);
+    assert(c[0] == 5 && c[1] == 2 && c[2] == 0 && c[3] == 1);
+
+    // g^e * (g^x)^y * (g^z)^w == 1 iff e + xy + zw == 0 (mod q)
+    Vec<ZZ> gExp;
+    Vec<Vec<ZZ>> pb, pe;
+    gExp.SetLength(N);
+    pb.SetLength(N);
+    pe.SetLength(N);
+    for (long n = 0; n < N; n++)
+    {
+        ZZ x(n + 1), y(2 * n + 5), z(7), w(n);
+        pb[n].append(PowerMod(g, x, p));
+        pe[n].append(y);
+        pb[n].append(PowerMod(g, z, p));
+        pe[n].append(w);
+        gExp[n] = (q - (x * y + z * w) % q) % q;
+    }
+    assert(BatchProductCheck(ok, g, gExp, pb, pe, q, p));
+    pe[17][1] += 1;
+    assert(!BatchProductCheck(ok, g, gExp, pb, pe, q, p));
+    for (long n = 0; n < N; n++)
+        assert(ok[n] == (n != 17));
+    std::cout << "Multi-exponentiation OK\n";
+}
+
+void testPrecomputePool() {
+    printHeader("Test precompute pool");
+    ZZ_p::init(ZZ(1019));
+    PrecomputePool<ZZ_p> pool([](ZZ_p &x) { x = random_ZZ_p(); }, 4);
+
+    // Synchronous fill stops at capacity; take falls back to inline production
+    pool.fill(10);
+    assert(pool.size() == 4);
+    ZZ_p x;
+    for (int i = 0; i < 4; i++)
+        assert(pool.tryTake(x));
+    assert(!pool.tryTake(x));
+    pool.take();
+
+    // Background producer refills the pool under the caller's modulus
+    pool.start();
+    for (int i = 0; i < 50; i++)
+    {
+        x = pool.take();
+        assert(rep(x) < 1019);
+    }
+    pool.stop();
+    assert(pool.size() <= pool.capacity());
+
+    // A producer failure surfaces in the consumer
+    PrecomputePool<ZZ_p> bad([](ZZ_p &) { throw std::runtime_error("offline"); }, 2);
+    bad.start();
+    bool thrown = false;
+    try
+    {
+        bad.take();
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Precompute pool OK\n";
+}
+
+void testPackedAffine() {
+    printHeader("Test packed affine key");
+    ZZ_p::init(ZZ(1000003));
+    MultiPoly<ZZ_p> F = generateFullPoly<ZZ_p>(5, 3, to_ZZ_p(2));
+    F.addTerm({0,3,0,0,0}, to_ZZ_p(17));
+    PackedAffine L = PackedAffine::random(5);
+    assert(L.length() == 5);
+
+    // The packed pass agrees with the per-variable MultiPoly form
+    ZZ_p a = to_ZZ_p(777);
+    Vec<ZZ_p> out;
+    L.evaluate(out, a);
+    std::vector<MultiPoly<ZZ_p>> ell;
+    for (long j = 0; j < 5; j++)
+    {
+        assert(out[j] == L.poly(j).evaluate({a}));
+        assert(out[j] == L.evaluate(j, a));
+        ell.push_back(L.poly(j));
+    }
+
+    // Composition by interpolation matches the symbolic compose
+    ZZ_pX f = L.compose(F);
+    assert(f == toZZ_pX(compose(F, ell)));
+    assert(deg(f) <= 3);
+
+    std::stringstream buf;
+    writeBinary(buf, L);
+    PackedAffine L2;
+    readBinary(buf, L2);
+    assert(L2.coeffs() == L.coeffs());
+    std::cout << "Packed affine key OK\n";
+}
+
+void testStragglerSim() {
+    printHeader("Test straggler simulation");
+    LatencyModel m = LatencyModel::parse("exp:1:4");
+    assert(m.kind == LatencyModel::Exponential && m.base == 1 && m.scale == 4);
+    assert(LatencyModel::parse(m.toString()).scale == 4);
+    bool threw = false;
+    try { LatencyModel::parse("exp:1"); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+
+    // Constant latencies: the first k are the fastest servers, in order
+    std::vector<LatencyModel> models = {LatencyModel::parse("const:5"), LatencyModel::parse("const:1")};
+    StragglerSim sim(models, 6);
+    std::vector<double> arrival;
+    sim.arrivals(arrival, {0, 0, 3, 0, 0, 2});
+    Vec<long> idx;
+    double t = StragglerSim::firstK(idx, arrival, 3);
+    assert(idx[0] == 1 && idx[1] == 3 && idx[2] == 5 && t == 3);
+    assert(StragglerSim::percentile({4, 1, 3, 2}, 50) == 2);
+    assert(StragglerSim::percentile({4, 1, 3, 2}, 100) == 4);
+
+    // Any k responders reconstruct the shared value
+    ZZ_p::init(ZZ(1000003));
+    ZZ_pX f;
+    random(f, 4);
+    Vec<long> who;
+    who.SetLength(5);
+    for (long r = 0; r < 5; r++)
+        who[r] = 9 - 2 * r;
+    Vec<ZZ_p> pts, w;
+    ResponderPoints(pts, who, 4, 10);
+    LagrangeWeights(w, pts, ZZ_p(0));
+    ZZ_p f0;
+    for (long r = 0; r < 4; r++)
+        f0 += w[r] * eval(f, pts[r]);
+    assert(f0 == ConstTerm(f));
+    who[1] = who[0];
+    threw = false;
+    try { ResponderPoints(pts, who, 4, 10); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+    std::cout << "Straggler simulation OK\n";
+}
+
+void testIncrementalEvaluator() {
+    printHeader("Test incremental evaluator");
+    ZZ_p::init(ZZ(1000003));
+    MultiPoly<ZZ_p> F = generateFullPoly<ZZ_p>(6, 3, to_ZZ_p(5));
+    F.addTerm({0,0,0,0,0,0}, to_ZZ_p(11));
+    IncrementalEvaluator<ZZ_p> inc(F);
+    assert(inc.termCount() == F.termCount());
+
+    std::vector<ZZ_p> pts(6);
+    for (long i = 0; i < 6; i++)
+        pts[i] = to_ZZ_p(3 * i + 1);
+    assert(inc.reset(pts) == F.evaluate(pts));
+
+    // Every update agrees with a full evaluation at the new point
+    for (long round = 0; round < 5; round++)
+    {
+        std::vector<size_t> vars = {size_t(round % 6), size_t((round + 2) % 6)};
+        std::vector<ZZ_p> vals = {random_ZZ_p(), random_ZZ_p()};
+        for (size_t i = 0; i < vars.size(); i++)
+            pts[vars[i]] = vals[i];
+        assert(inc.update(vars, vals) == F.evaluate(pts));
+    }
+    // Repeating a variable keeps the last value
+    pts[4] = to_ZZ_p(9);
+    assert(inc.update({4, 4}, {to_ZZ_p(8), to_ZZ_p(9)}) == F.evaluate(pts));
+    assert(inc.update({}, {}) == F.evaluate(pts));
+    std::cout << "Incremental evaluator OK\n";
+}
+
+void testDecodeRS() {
+    printHeader("Test Reed-Solomon decoding");
+    ZZ_p::init(ZZ(1000003));
+    // 11 responses from servers 2..12, two columns of dimension 3 and 5
+    long n = 11;
+    ZZ_pX f0, f1;
+    for (long i = 0; i < 3; i++)
+        SetCoeff(f0, i, random_ZZ_p());
+    for (long i = 0; i < 5; i++)
+        SetCoeff(f1, i, random_ZZ_p());
+    Vec<long> idx;
+    Mat<ZZ_p> pi;
+    idx.SetLength(n);
+    pi.SetDims(n, 2);
+    for (long r = 0; r < n; r++)
+    {
+        idx[r] = r + 2;
+        eval(pi[r][0], f0, to_ZZ_p(idx[r]));
+        eval(pi[r][1], f1, to_ZZ_p(idx[r]));
+    }
+    Vec<long> dims;
+    dims.SetLength(2);
+    dims[0] = 3;
+    dims[1] = 5;
+
+    // (11 - 5) / 2 = 3 faulty servers are corrected, spread over both columns
+    pi[1][0] += 1;
+    pi[6][1] += 7;
+    pi[9][0] += 2;
+    pi[9][1] += 2;
+    Vec<ZZ_p> at0;
+    Vec<long> bad;
+    assert(DecodeResponses(at0, bad, pi, idx, dims, 20));
+    assert(at0[0] == coeff(f0, 0) && at0[1] == coeff(f1, 0));
+    assert(bad.length() == 3 && bad[0] == 3 && bad[1] == 8 && bad[2] == 11);
+
+    // Four faulty rows in the dimension-5 column are beyond the radius
+    pi[0][1] += 1;
+    pi[4][1] += 1;
+    assert(!DecodeResponses(at0, bad, pi, idx, dims, 20));
+    std::cout << "Reed-Solomon decoding OK\n";
+}
+
+void testQuadraticPoly() {
+    printHeader("Test quadratic form");
+    MultiPoly<int> F(4, 2);
+    F.addTerm({0,0,0,0}, 7);
+    F.addTerm({0,0,1,0}, -2);
+    F.addTerm({2,0,0,0}, 3);
+    F.addTerm({0,1,0,1}, 5);
+    F.addTerm({1,0,1,0}, -4);
+    QuadraticPoly<int> Q(F);
+    assert(Q.termCount() == F.termCount());
+    assert(Q.quadratic(3, 1) == 5 && Q.quadratic(1, 3) == 5);
+    assert(Q.evaluate({2, -1, 3, 4}) == F.evaluate({2, -1, 3, 4}));
+
+    auto G = generateFullPoly<int>(6, 2, 3);
+    auto H = generateFullQuadratic<int>(6, 3);
+    assert(QuadraticPoly<int>(G).termCount() == G.termCount());
+    assert(H.termCount() == G.termCount());
+    assert(H.evaluate({1, 2, -3, 0, 5, -1}) == G.evaluate({1, 2, -3, 0, 5, -1}));
+
+    // ZZ_p rows are reduced once, not per product
+    ZZ_p::init((ZZ(1) << 127) - 1);
+    auto Gp = generateFullPoly<ZZ_p>(7, 2, random_ZZ_p());
+    QuadraticPoly<ZZ_p> Qp(Gp);
+    Qp.quadratic(2, 5) = random_ZZ_p();
+    Gp = MultiPoly<ZZ_p>(7, 2);
+    Gp.addTerm({0,0,0,0,0,0,0}, Qp.constant());
+    for (int i = 0; i < 7; i++)
+    {
+        std::vector<int> e(7, 0);
+        e[i] = 1;
+        Gp.addTerm(e, Qp.linear(i));
+        for (int j = i; j < 7; j++)
+        {
+            std::vector<int> f = e;
+            f[j]++;
+            Gp.addTerm(f, Qp.quadratic(i, j));
+        }
+    }
+    std::vector<ZZ_p> xp(7);
+    for (auto &v : xp)
+        v = random_ZZ_p();
+    assert(Qp.evaluate(xp) == Gp.evaluate(xp));
+
+    bool threw = false;
+    try { QuadraticPoly<int> bad(generateFullPoly<int>(2, 3)); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+    std::cout << "Quadratic form OK\n";
+}
+
+void testLinearForms() {
+    printHeader("Test linear forms");
+    std::vector<MultiPoly<int>> F;
+    for (int j = 0; j < 6; j++)
+    {
+        MultiPoly<int> P(5, 1);
+        P.addTerm({0,0,0,0,0}, j - 2);
+        for (int i = 0; i < 5; i++)
+        {
+            std::vector<int> e(5, 0);
+            e[i] = 1;
+            P.addTerm(e, (i + 1) * (j % 3 - 1));
+        }
+        F.push_back(P);
+    }
+    LinearForms<int> L(F);
+    assert(L.outputCount() == 6 && L.varCount() == 5);
+    std::vector<int> x = {3, -1, 4, 1, -5}, out;
+    L.evaluate(out, x);
+    for (int j = 0; j < 6; j++)
+        assert(out[j] == F[j].evaluate(x));
+
+    // ZZ_p rows are reduced once, not per product
+    ZZ_p::init((ZZ(1) << 127) - 1);
+    LinearForms<ZZ_p> Lp(3, 8);
+    std::vector<ZZ_p> xp(8), outp;
+    for (auto &v : xp)
+        v = random_ZZ_p();
+    for (int j = 0; j < 3; j++)
+    {
+        Lp.offset(j) = random_ZZ_p();
+        for (int i = 0; i < 8; i++)
+            Lp.weight(j, i) = random_ZZ_p();
+    }
+    Lp.evaluate(outp, xp);
+    for (int j = 0; j < 3; j++)
+    {
+        ZZ_p s = Lp.offset(j);
+        for (int i = 0; i < 8; i++)
+            s += Lp.weight(j, i) * xp[i];
+        assert(outp[j] == s);
+    }
+
+    bool threw = false;
+    try { L.setRow(0, generateFullPoly<int>(5, 2)); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+    std::cout << "Linear forms OK\n";
+}
+
+void testCircuit() {
+    printHeader("Test arithmetic circuit");
+    // (2 + x0 + x1 + x2)^3 against its expansion
+    auto C = generateProductOfSums<int>(3, 3, 2);
+    MultiPoly<int> S(3, 1);
+    S.addTerm({0,0,0}, 2);
+    S.addTerm({1,0,0}, 1);
+    S.addTerm({0,1,0}, 1);
+    S.addTerm({0,0,1}, 1);
+    auto F = polyPow(S, 3, 3);
+    assert(C.maxDegree() == 3 && C.degree(C.output()) == 3);
+    assert(C.evaluate({1, -2, 4}) == F.evaluate({1, -2, 4}));
+
+    // x0 * x1 + 5 * x2
+    Circuit<int> D(3, 2);
+    D.setOutput(D.add(D.mul(D.input(0), D.input(1)), D.mul(D.constant(5), D.input(2))));
+    assert(D.gateCount() == 4);
+    assert(D.evaluate({3, 4, -1}) == 7);
+
+    bool threw = false;
+    try { D.mul(D.output(), D.input(0)); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+    std::cout << "Arithmetic circuit OK\n";
+}
+
+void testKronecker() {
+    printHeader("Test Kronecker multiplication");
+    ZZ_p::init(ZZ(1000003));
+    auto toZZp = [](const MultiPoly<int> &P) {
+        MultiPoly<ZZ_p> Q(P.varCount(), P.maxDegree());
+        for (const auto &[e, c] : P.terms())
+            Q.addTerm(e, to_ZZ_p(c));
+        return Q;
+    };
+    auto A = generateFullPoly<int>(3, 3, 2);
+    A.addTerm({1,2,0}, 5);
+    MultiPoly<int> B(4, 2);
+    B.addTerm({0,0,0,0}, -1);
+    B.addTerm({0,2,0,0}, 3);
+    B.addTerm({1,0,0,1}, 7);
+    B.addTerm({0,0,1,0}, 4);
+
+    // The int product is always the naive loop
+    auto C = toZZp(A * B);
+    auto K = toZZp(A).mulKronecker(toZZp(B));
+    assert(K.varCount() == 4 && K.maxDegree() == 5);
+    assert(K.terms() == C.terms());
+    assert((toZZp(A) * toZZp(B)).terms() == C.terms());
+    assert(toZZp(A).mulKronecker(toZZp(A)).terms() == toZZp(A * A).terms());
+
+    auto S = toZZp(generateFullPoly<int>(3, 1));
+    assert(polyPow(S, 4, 4).terms() == toZZp(polyPow(generateFullPoly<int>(3, 1), 4, 4)).terms());
+    std::cout << "Kronecker multiplication OK\n";
+}
+
+void testMonomialEnumerator() {
+    printHeader("Test monomial enumerator");
+    for (auto [m, d] : std::vector<std::pair<size_t, int>>{{1, 4}, {3, 0}, {3, 3}, {5, 2}})
+    {
+        // Same terms and order as inserting every monomial through addTerm
+        MultiPoly<int> ref(m, d);
+        std::vector<std::vector<int>> seen;
+        for (MonomialEnumerator it(m, d); !it.done(); ++it)
+        {
+            ref.addTerm(*it, 1);
+            seen.push_back(*it);
+        }
+        assert(seen.size() == MonomialEnumerator::count(m, d));
+        assert(std::is_sorted(seen.begin(), seen.end()));
+
+        // Leading-exponent ranges are contiguous pieces of the full order
+        size_t pos = 0;
+        for (int k = 0; k <= d; k++)
+        {
+            size_t n = 0;
+            for (MonomialEnumerator it(m, d, k, k + 1); !it.done(); ++it, ++n)
+                assert(*it == seen[pos + n]);
+            assert(n == MonomialEnumerator::countLeading(m, d, k));
+            pos += n;
+        }
+        assert(pos == seen.size());
+
+        assert(generateFullPoly<int>(m, d, 1).terms() == ref.terms());
+        assert(generateFullPoly<int>(m, d, 3, 4).terms() == generateFullPoly<int>(m, d, 3).terms());
+    }
+
+    MultiPoly<int> P(2, 2);
+    P.appendSorted({0, 1}, 4);
+    P.appendSorted({1, 0}, 5);
+    bool threw = false;
+    try { P.appendSorted({0, 2}, 1); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw && P.termCount() == 2);
+    std::cout << "Monomial enumerator OK\n";
+}
+
+void testWorkload() {
+    printHeader("Test sparse workloads");
+    ZZ_p::init(ZZ(1000003));
+    auto w = WorkloadSpec::parse("sparse:300:0.25:top:small:9");
+    assert(w.kind == WorkloadSpec::Sparse && w.terms == 300 && w.degree == WorkloadSpec::Top);
+    assert(WorkloadSpec::parse(w.toString()).toString() == w.toString());
+
+    auto F = generateWorkload(w, 60, 3);
+    assert(F.termCount() == 300);
+    std::vector<bool> used(60, false);
+    for (const auto &[e, c] : F.terms())
+    {
+        assert(std::accumulate(e.begin(), e.end(), 0) == 3);
+        for (size_t i = 0; i < e.size(); i++)
+            used[i] = used[i] || e[i] > 0;
+    }
+    assert(std::count(used.begin(), used.end(), true) < 30);
+
+    // Same seed, same F and X; another seed, another F
+    assert(generateWorkload(w, 60, 3).terms() == F.terms());
+    Vec<Fq> X1 = generateWorkloadInput(w, 60), X2 = generateWorkloadInput(w, 60);
+    assert(X1 == X2);
+    assert(generateWorkload(WorkloadSpec::parse("sparse:300:0.25:top:small:10"), 60, 3).terms() != F.terms());
+
+    // Every monomial of degree <= 2 in 3 variables, and most of them under a
+    // skewed degree distribution, without running out of distinct draws
+    auto All = generateWorkload(WorkloadSpec::parse("sparse:10:1:geom:one:3"), 3, 2);
+    assert(All.terms() == generateFullPoly<Fq>(3, 2, to_ZZ_p(1)).terms());
+    for (int seed = 1; seed <= 20; seed++)
+    {
+        auto ws = WorkloadSpec::parse("sparse:50:1:geom:small:" + std::to_string(seed));
+        auto G = generateWorkload(ws, 4, 4);
+        assert(G.termCount() == 50 && generateWorkload(ws, 4, 4).terms() == G.terms());
+    }
+
+    // The full workload is reproducible too
+    auto full = WorkloadSpec::parse("full");
+    assert(generateWorkload(full, 4, 2).terms() == generateWorkload(full, 4, 2).terms());
+
+    bool threw = false;
+    try { generateWorkload(WorkloadSpec::parse("sparse:50:1:top"), 2, 2); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { WorkloadSpec::parse("dense:10"); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+    std::cout << "Sparse workloads OK\n";
+}
+
+void testPolyLoader() {
+    printHeader("Test polynomial loader");
+    ZZ_p::init(ZZ(1000003));
+    const char *text = "loader_test.txt", *bin = "loader_test.bin";
+    {
+        std::ofstream out(text);
+        out << "# three variables, degree 3\n"
+            << "3 3\n"
+            << "5 2 0 0\n"
+            << "\n"
+            << "-4\n"
+            << "  7 1\t1\n"
+            << "# repeated and cancelling monomials\n"
+            << "3 0 2 0\n"
+            << "1000004 2\n"
+            << "-7 1 1\n"
+            << "123456789012345678901234567890 0 1 2\n";
+    }
+    MultiPoly<ZZ_p> F(3, 3);
+    F.addTerm({2,0,1}, to_ZZ_p(8));
+    F.addTerm({0,0,0}, to_ZZ_p(-4));
+    F.addTerm({0,0,1}, to_ZZ_p(1));
+    ZZ big;
+    conv(big, "123456789012345678901234567890");
+    F.addTerm({1,1,1}, to_ZZ_p(big));
+    for (unsigned threads : {1u, 3u})
+    {
+        assert(loadTextPoly(text, threads).terms() == F.terms());
+        // Spilled runs sum and cancel repeated monomials across chunks too
+        convertTextPoly(text, bin, threads);
+        assert(MappedPoly::open(bin).load().terms() == F.terms());
+    }
+
+    // Text round trip, and a larger polynomial through every path
+    auto G = generateWorkload(WorkloadSpec::parse("sparse:2000:0.5:uniform:random:3"), 40, 4);
+    {
+        std::ofstream out(text);
+        writeTextPoly(out, G);
+    }
+    assert(loadTextPoly(text, 4).terms() == G.terms());
+    convertTextPoly(text, bin, 2);
+    assert(MappedPoly::open(bin).load().terms() == G.terms());
+    assert(loadBinaryPoly(bin, 0, 3).terms() == G.terms());
+    writeFullPoly(bin, 5, 3, [] { return to_ZZ_p(2); });
+    assert(loadBinaryPoly(bin, 0, 2).terms() == generateFullPoly<ZZ_p>(5, 3, to_ZZ_p(2)).terms());
+
+    bool threw = false;
+    {
+        std::ofstream out(text);
+        out << "2 2\n1 0 2\n";
+    }
+    try { loadTextPoly(text); } catch (const std::out_of_range &) { threw = true; }
+    assert(threw);
+    std::remove(text);
+    std::remove(bin);
+    std::cout << "Polynomial loader OK\n";
+}
+
+void testPackedRH5() {
+    printHeader("Test packed RH5");
+    const int ell = 3;
+    RH5::Packed::Env env;
+    RH5::Packed::Initialize(env, 1, ell, 128);
+    auto F = generateFullPoly<Fq>(5, 2, to_ZZ_p(7));
+    F.addTerm({2,0,0,0,0}, to_ZZ_p(11));
+    RH5::Packed::PK_F pk;
+    RH5::Packed::VK_F vk_f;
+    RH5::Packed::EK_F ek;
+    RH5::Packed::KeyGen(pk, vk_f, ek, env, F);
+    assert(env.k == 3 * (1 + ell - 1) + 1 && env.n == env.k);
+
+    Vec<Vec<Fq>> Xs;
+    Xs.SetLength(ell);
+    for (int s = 0; s < ell; s++)
+        random(Xs[s], env.m);
+    Mat<Fq> sigma;
+    RH5::Packed::VK_X vk_x;
+    RH5::Packed::ProbGen(vk_x, sigma, env, pk, Xs);
+    Vec<Fq> theta;
+    RH5::Packed::VK_theta vk_theta;
+    RH5::Packed::SK_theta sk_theta;
+    RH5::Packed::MaskGen(vk_theta, sk_theta, theta, env, vk_x);
+    Mat<Fq> pi;
+    pi.SetDims(env.k, 2);
+    for (int i = 0; i < env.k; i++)
+        RH5::Packed::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+
+    assert(RH5::Packed::Verify(vk_f, vk_x, pi, env));
+    Vec<Fq> res;
+    RH5::Packed::Reconstruct(res, sk_theta, pi, env);
+    assert(res.length() == ell);
+    for (int s = 0; s < ell; s++)
+    {
+        std::vector<Fq> x(Xs[s].begin(), Xs[s].end());
+        assert(res[s] == F.evaluate(x));
+    }
+
+    // One tampered server response fails the check for the whole round
+    pi[2][0] += 1;
+    assert(!RH5::Packed::Verify(vk_f, vk_x, pi, env));
+    std::cout << "Packed RH5 OK, " << ell << " slots on " << env.k << " servers\n";
+}
+
+void testRH5Session() {
+    printHeader("Test RH5 incremental session");
+    RH5::Env env;
+    RH5::Initialize(env, 1, 128);
+    auto F = generateFullPoly<Fq>(6, 2, to_ZZ_p(3));
+    F.addTerm({0,2,0,0,0,0}, to_ZZ_p(-8));
+    RH5::PK_F pk;
+    RH5::VK_F vk_f;
+    RH5::EK_F ek;
+    RH5::KeyGen(pk, vk_f, ek, env, F);
+    std::vector<IncrementalEvaluator<Fq>> state;
+    for (int i = 0; i < env.k; i++)
+        state.emplace_back(ek[i]);
+
+    RH5::Session session;
+    Vec<Fq> X = random_vec_ZZ_p(env.m);
+    RH5::VK_X vk_x;
+    Mat<Fq> sigma, pi;
+    pi.SetDims(env.k, 2);
+    RH5::SessionStart(session, vk_x, sigma, env, pk, X);
+    for (int round = 0; round <= 3; round++)
+    {
+        Vec<long> vars;
+        Mat<Fq> delta;
+        if (round > 0)
+        {
+            // Round 3 pads the update to a cover set of four coordinates
+            session.cover = round == 3 ? 4 : 0;
+            X[round] += 1;
+            X[5] = random_ZZ_p();
+            RH5::SessionUpdate(session, vk_x, vars, delta, env, pk, X);
+            assert(vars.length() == (round == 3 ? 4 : 2));
+            assert(std::find(vars.begin(), vars.end(), round) != vars.end());
+        }
+        RH5::VK_theta vk_theta;
+        RH5::SK_theta sk_theta;
+        Vec<Fq> theta;
+        RH5::MaskGen(vk_theta, sk_theta, theta, env, vk_x);
+        for (int i = 0; i < env.k; i++)
+        {
+            if (round == 0)
+                RH5::ComputeStart(pi[i], state[i], i, sigma[i], theta[i], env);
+            else
+                RH5::ComputeUpdate(pi[i], state[i], i, vars, delta[i], theta[i], env);
+        }
+        assert(RH5::Verify(vk_f, vk_x, pi, env));
+        Fq res;
+        RH5::Reconstruct(res, sk_theta, pi, env);
+        assert(res == F.evaluate(std::vector<Fq>(X.begin(), X.end())));
+    }
+    std::cout << "Session OK over 3 updates\n";
+}
+
+void testUpdateKey() {
+    printHeader("Test UpdateKey");
+    // Sparse change to a full quadratic in six variables; built after
+    // Initialize has set the field
+    auto makeDelta = [] {
+        MultiPoly<Fq> delta(6, 2);
+        delta.addTerm({1,0,0,1,0,0}, to_ZZ_p(9));
+        delta.addTerm({0,0,2,0,0,0}, to_ZZ_p(-2));
+        delta.addTerm({0,0,0,0,0,0}, to_ZZ_p(4));
+        return delta;
+    };
+    auto direct = [](const MultiPoly<Fq> &P, const Vec<Fq> &X) {
+        return P.evaluate(std::vector<Fq>(X.begin(), X.end()));
+    };
+
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(6, 2, to_ZZ_p(5));
+        auto delta = makeDelta();
+        SP4::PK_F pk;
+        SP4::VK_F vk_f;
+        SP4::EK_F ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        // Term-by-term composition agrees with the interpolating one
+        assert(pk.ell.composeTerms(delta) == pk.ell.compose(delta));
+        SP4::UpdateKey(pk, vk_f, ek, env, delta);
+        assert(pk.f == pk.ell.compose(F + delta));
+
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        SP4::VK_X vk_x;
+        Mat<Fq> sigma;
+        SP4::ProbGen(vk_x, sigma, env, pk, X);
+        Vec<Fq> pi;
+        pi.SetLength(env.k);
+        for (int i = 0; i < env.k; i++)
+            SP4::Compute(pi[i], i, ek[i], sigma[i], env);
+        Fq res;
+        assert(SP4::Verify(res, vk_f, vk_x, pi, env));
+        assert(res == direct(F + delta, X));
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(6, 2, to_ZZ_p(5));
+        auto delta = makeDelta();
+        RH4::PK_F pk;
+        RH4::VK_F vk_f;
+        RH4::EK_F ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        RH4::UpdateKey(pk, vk_f, ek, env, delta);
+
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        RH4::VK_X vk_x;
+        Mat<Fq> sigma;
+        RH4::ProbGen(vk_x, sigma, env, pk, X);
+        RH4::VK_theta vk_theta;
+        RH4::SK_theta sk;
+        Vec<Fq> theta;
+        RH4::MaskGen(vk_theta, sk, theta, env, vk_x);
+        Vec<Fq> pi;
+        pi.SetLength(env.k);
+        for (int i = 0; i < env.k; i++)
+            RH4::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+        assert(RH4::Verify(vk_f, vk_theta, pi, env));
+        Fq res;
+        RH4::Reconstruct(res, sk, pi, env);
+        assert(res == direct(F + delta, X));
+    }
+    std::cout << "UpdateKey OK for SP4 and RH4\n";
+}
+
+void testVerifyRobust() {
+    printHeader("Test VerifyRobust");
+    // Every scheme answers on n = 10 servers and servers 2 and 7 lie; with
+    // k <= 5 both are corrected and named
+    const long n = 10;
+    Vec<long> idx, bad;
+    idx.SetLength(n);
+    for (long i = 0; i < n; i++)
+        idx[i] = i;
+    auto corrupt = [](Fq &x) { x += 1; };
+    auto named = [](const Vec<long> &b) { return b.length() == 2 && b[0] == 2 && b[1] == 7; };
+    auto direct = [](const MultiPoly<Fq> &P, const Vec<Fq> &X) {
+        return P.evaluate(std::vector<Fq>(X.begin(), X.end()));
+    };
+    Fq res;
+
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        env.n = n;
+        auto F = generateFullPoly<Fq>(5, 2, to_ZZ_p(3));
+        SP4::PK_F pk;
+        SP4::VK_F vk_f;
+        SP4::EK_F ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        SP4::VK_X vk_x;
+        Mat<Fq> sigma;
+        SP4::ProbGen(vk_x, sigma, env, pk, X);
+        Vec<Fq> pi;
+        pi.SetLength(n);
+        for (int i = 0; i < n; i++)
+            SP4::Compute(pi[i], i, ek[i], sigma[i], env);
+        corrupt(pi[2]);
+        corrupt(pi[7]);
+        assert(SP4::VerifyRobust(res, bad, vk_f, vk_x, pi, idx, env));
+        assert(res == direct(F, X) && named(bad));
+        // k = 5 of 10 corrects at most two
+        corrupt(pi[4]);
+        assert(!SP4::VerifyRobust(res, bad, vk_f, vk_x, pi, idx, env));
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        env.n = n;
+        auto F = generateFullPoly<Fq>(5, 2, to_ZZ_p(3));
+        RH4::PK_F pk;
+        RH4::VK_F vk_f;
+        RH4::EK_F ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        RH4::VK_X vk_x;
+        Mat<Fq> sigma;
+        RH4::ProbGen(vk_x, sigma, env, pk, X);
+        RH4::VK_theta vk_theta;
+        RH4::SK_theta sk;
+        Vec<Fq> theta;
+        RH4::MaskGen(vk_theta, sk, theta, env, vk_x);
+        Vec<Fq> pi;
+        pi.SetLength(n);
+        for (int i = 0; i < n; i++)
+            RH4::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+        corrupt(pi[2]);
+        corrupt(pi[7]);
+        assert(RH4::VerifyRobust(res, bad, vk_f, vk_theta, sk, pi, idx, env));
+        assert(res == direct(F, X) && named(bad));
+    }
+    {
+        SP5::Env env;
+        SP5::Initialize(env, 1, 128);
+        env.n = n;
+        auto F = generateFullPoly<Fq>(5, 2, to_ZZ_p(3));
+        SP5::PK_F pk;
+        SP5::VK_F vk_f;
+        SP5::EK_F ek;
+        SP5::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        SP5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        SP5::ProbGen(vk_x, sigma, env, pk, X);
+        pi.SetDims(n, 2);
+        for (int i = 0; i < n; i++)
+            SP5::Compute(pi[i], i, ek[i], sigma[i], env);
+        corrupt(pi[2][0]);
+        corrupt(pi[7][1]);
+        assert(SP5::VerifyRobust(res, bad, vk_f, vk_x, pi, idx, env));
+        assert(res == direct(F, X) && named(bad));
+    }
+    {
+        CH5::Env env;
+        CH5::Initialize(env, 1, 128);
+        env.n = n;
+        auto F = generateFullPoly<Fq>(5, 2, to_ZZ_p(3));
+        CH5::PK_F pk;
+        CH5::VK_F vk_f;
+        CH5::EK_F ek;
+        CH5::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        CH5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        CH5::ProbGen(vk_x, sigma, env, pk, X);
+        pi.SetDims(n, 2);
+        for (int i = 0; i < n; i++)
+            CH5::Compute(pi[i], i, ek[i], sigma[i], env);
+        corrupt(pi[2][1]);
+        corrupt(pi[7][0]);
+        assert(CH5::VerifyRobust(res, bad, vk_f, vk_x, pi, idx, env));
+        assert(res == direct(F, X) && named(bad));
+    }
+    {
+        RH5::Env env;
+        RH5::Initialize(env, 1, 128);
+        env.n = n;
+        auto F = generateFullPoly<Fq>(5, 2, to_ZZ_p(3));
+        RH5::PK_F pk;
+        RH5::VK_F vk_f;
+        RH5::EK_F ek;
+        RH5::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        RH5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        RH5::ProbGen(vk_x, sigma, env, pk, X);
+        RH5::VK_theta vk_theta;
+        RH5::SK_theta sk;
+        Vec<Fq> theta;
+        RH5::MaskGen(vk_theta, sk, theta, env, vk_x);
+        pi.SetDims(n, 2);
+        for (int i = 0; i < n; i++)
+            RH5::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+        corrupt(pi[2][0]);
+        corrupt(pi[7][0]);
+        corrupt(pi[7][1]);
+        assert(RH5::VerifyRobust(res, bad, vk_f, vk_x, sk, pi, idx, env));
+        assert(res == direct(F, X) && named(bad));
+    }
+    std::cout << "VerifyRobust OK for all five schemes\n";
+}
+
+void testMultiOutput() {
+    printHeader("Test vector-valued F");
+    const long r = 3;
+    // Outputs of different degrees over the same four variables; built after
+    // Initialize has set the field
+    auto makeF = [] {
+        Vec<MultiPoly<Fq>> F;
+        F.SetLength(r);
+        F[0] = generateFullPoly<Fq>(4, 2, to_ZZ_p(2));
+        F[1] = generateFullPoly<Fq>(4, 1, to_ZZ_p(-5));
+        F[2] = MultiPoly<Fq>(4, 2);
+        F[2].addTerm({1,0,0,1}, to_ZZ_p(7));
+        F[2].addTerm({0,2,0,0}, to_ZZ_p(3));
+        return F;
+    };
+    // res[j] == F_j(X) for every output
+    auto matches = [](const Vec<Fq> &res, const Vec<MultiPoly<Fq>> &F, const Vec<Fq> &X) {
+        std::vector<Fq> x(X.begin(), X.end());
+        if (res.length() != F.length())
+            return false;
+        for (long j = 0; j < F.length(); j++)
+            if (res[j] != F[j].evaluate(x))
+                return false;
+        return true;
+    };
+    // The tamper cases change one response. Share points are 0..k-1, so for
+    // the 5-variants, whose check is at 0, only server 0's row is checked
+    // when exactly k rows arrive; SP4 and RH4 check phi at alpha instead.
+    Vec<Fq> res;
+
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        auto F = makeF();
+        SP4::PK_FV pk;
+        SP4::VK_FV vk_f;
+        SP4::EK_FV ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        SP4::VK_XV vk_x;
+        Mat<Fq> sigma, pi;
+        SP4::ProbGenMulti(vk_x, sigma, env, pk, X);
+        pi.SetDims(env.k, r);
+        for (int i = 0; i < env.k; i++)
+            SP4::ComputeMulti(pi[i], i, ek[i], sigma[i], env);
+        assert(SP4::VerifyMulti(res, vk_f, vk_x, pi, env) && matches(res, F, X));
+        pi[1][2] += 1;
+        assert(!SP4::VerifyMulti(res, vk_f, vk_x, pi, env));
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        auto F = makeF();
+        RH4::PK_FV pk;
+        RH4::VK_FV vk_f;
+        RH4::EK_FV ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        RH4::VK_XV vk_x;
+        Mat<Fq> sigma, theta, pi;
+        RH4::ProbGenMulti(vk_x, sigma, env, pk, X);
+        RH4::VK_thetaV vk_theta;
+        Vec<Fq> sk;
+        RH4::MaskGenMulti(vk_theta, sk, theta, env, vk_x);
+        pi.SetDims(env.k, r);
+        for (int i = 0; i < env.k; i++)
+            RH4::ComputeMulti(pi[i], i, ek[i], sigma[i], theta[i], env);
+        assert(RH4::VerifyMulti(vk_f, vk_theta, pi, env));
+        RH4::ReconstructMulti(res, sk, pi, env);
+        assert(matches(res, F, X));
+        pi[0][1] += 1;
+        assert(!RH4::VerifyMulti(vk_f, vk_theta, pi, env));
+    }
+    {
+        SP5::Env env;
+        SP5::Initialize(env, 1, 128);
+        auto F = makeF();
+        SP5::PK_F pk;
+        SP5::VK_F vk_f;
+        SP5::EK_FV ek;
+        SP5::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        SP5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        SP5::ProbGen(vk_x, sigma, env, pk, X);
+        pi.SetDims(env.k, 2 * r);
+        for (int i = 0; i < env.k; i++)
+            SP5::ComputeMulti(pi[i], i, ek[i], sigma[i], env);
+        assert(SP5::VerifyMulti(res, vk_f, vk_x, pi, env) && matches(res, F, X));
+        pi[0][3] += 1;
+        assert(!SP5::VerifyMulti(res, vk_f, vk_x, pi, env));
+    }
+    {
+        CH5::Env env;
+        CH5::Initialize(env, 1, 128);
+        auto F = makeF();
+        CH5::PK_F pk;
+        CH5::VK_F vk_f;
+        CH5::EK_FV ek;
+        CH5::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        CH5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        CH5::ProbGenMulti(vk_x, sigma, env, pk, X, r);
+        assert(sigma.NumCols() == env.m + 1 + 2 * r);
+        pi.SetDims(env.k, 2 * r);
+        for (int i = 0; i < env.k; i++)
+            CH5::ComputeMulti(pi[i], i, ek[i], sigma[i], env);
+        assert(CH5::VerifyMulti(res, vk_f, vk_x, pi, env) && matches(res, F, X));
+        pi[0][4] += 1;
+        assert(!CH5::VerifyMulti(res, vk_f, vk_x, pi, env));
+
+        // Context hiding across outputs: with F_0 == F_1 the client must not
+        // see phi_0 - phi_1 = 0 at the servers, so the masks must differ
+        F[1] = F[0];
+        CH5::KeyGen(pk, vk_f, ek, env, F);
+        CH5::ProbGenMulti(vk_x, sigma, env, pk, X, r);
+        for (int i = 1; i < env.k; i++)
+        {
+            CH5::ComputeMulti(pi[i], i, ek[i], sigma[i], env);
+            assert(pi[i][0] != pi[i][2] && pi[i][1] != pi[i][3]);
+        }
+        CH5::ComputeMulti(pi[0], 0, ek[0], sigma[0], env);
+        assert(CH5::VerifyMulti(res, vk_f, vk_x, pi, env) && res[0] == res[1]);
+
+        // A single-output sigma does not carry masks for r outputs
+        CH5::ProbGen(vk_x, sigma, env, pk, X);
+        bool threw = false;
+        try { CH5::ComputeMulti(pi[0], 0, ek[0], sigma[0], env); } catch (const std::invalid_argument &) { threw = true; }
+        assert(threw);
+    }
+    {
+        RH5::Env env;
+        RH5::Initialize(env, 1, 128);
+        auto F = makeF();
+        RH5::PK_F pk;
+        RH5::VK_F vk_f;
+        RH5::EK_FV ek;
+        RH5::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        RH5::VK_X vk_x;
+        Mat<Fq> sigma, theta, pi;
+        RH5::ProbGen(vk_x, sigma, env, pk, X);
+        RH5::VK_theta vk_theta;
+        Vec<Fq> sk;
+        RH5::MaskGenMulti(vk_theta, sk, theta, env, vk_x, r);
+        pi.SetDims(env.k, 2 * r);
+        for (int i = 0; i < env.k; i++)
+            RH5::ComputeMulti(pi[i], i, ek[i], sigma[i], theta[i], env);
+        assert(RH5::VerifyMulti(vk_f, vk_x, pi, env));
+        RH5::ReconstructMulti(res, sk, pi, env);
+        assert(matches(res, F, X));
+        pi[0][5] += 1;
+        assert(!RH5::VerifyMulti(vk_f, vk_x, pi, env));
+    }
+    std::cout << "Vector-valued F OK for all five schemes\n";
+}
+
+void testProbGenBatch() {
+    printHeader("Test batched ProbGen");
+    // N inputs shared with one Vandermonde table; each instance must verify
+    // and reconstruct F(X_n) on its own
+    const long N = 3;
+    auto direct = [](const MultiPoly<Fq> &P, const Vec<Fq> &X) {
+        return P.evaluate(std::vector<Fq>(X.begin(), X.end()));
+    };
+    auto inputs = [](long m) {
+        Vec<Vec<Fq>> Xs;
+        Xs.SetLength(N);
+        for (long n = 0; n < N; n++)
+            Xs[n] = random_vec_ZZ_p(m);
+        return Xs;
+    };
+    Fq res;
+
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP4::PK_F pk;
+        SP4::VK_F vk_f;
+        SP4::EK_F ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<SP4::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma;
+        SP4::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        assert(vk_x.length() == N && sigma.length() == N);
+        for (long n = 0; n < N; n++)
+        {
+            Vec<Fq> pi;
+            pi.SetLength(env.k);
+            for (int i = 0; i < env.k; i++)
+                SP4::Compute(pi[i], i, ek[i], sigma[n][i], env);
+            assert(SP4::Verify(res, vk_f, vk_x[n], pi, env) && res == direct(F, Xs[n]));
+        }
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH4::PK_F pk;
+        RH4::VK_F vk_f;
+        RH4::EK_F ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<RH4::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma;
+        RH4::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        for (long n = 0; n < N; n++)
+        {
+            RH4::VK_theta vk_theta;
+            RH4::SK_theta sk;
+            Vec<Fq> theta, pi;
+            RH4::MaskGen(vk_theta, sk, theta, env, vk_x[n]);
+            pi.SetLength(env.k);
+            for (int i = 0; i < env.k; i++)
+                RH4::Compute(pi[i], i, ek[i], sigma[n][i], theta[i], env);
+            assert(RH4::Verify(vk_f, vk_theta, pi, env));
+            RH4::Reconstruct(res, sk, pi, env);
+            assert(res == direct(F, Xs[n]));
+        }
+    }
+    {
+        SP5::Env env;
+        SP5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP5::PK_F pk;
+        SP5::VK_F vk_f;
+        SP5::EK_F ek;
+        SP5::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<SP5::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma;
+        SP5::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        for (long n = 0; n < N; n++)
+        {
+            Mat<Fq> pi;
+            pi.SetDims(env.k, 2);
+            for (int i = 0; i < env.k; i++)
+                SP5::Compute(pi[i], i, ek[i], sigma[n][i], env);
+            assert(SP5::Verify(res, vk_f, vk_x[n], pi, env) && res == direct(F, Xs[n]));
+        }
+    }
+    {
+        CH5::Env env;
+        CH5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        CH5::PK_F pk;
+        CH5::VK_F vk_f;
+        CH5::EK_F ek;
+        CH5::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<CH5::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma;
+        CH5::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        for (long n = 0; n < N; n++)
+        {
+            Mat<Fq> pi;
+            pi.SetDims(env.k, 2);
+            for (int i = 0; i < env.k; i++)
+                CH5::Compute(pi[i], i, ek[i], sigma[n][i], env);
+            assert(CH5::Verify(res, vk_f, vk_x[n], pi, env) && res == direct(F, Xs[n]));
+        }
+    }
+    {
+        RH5::Env env;
+        RH5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH5::PK_F pk;
+        RH5::VK_F vk_f;
+        RH5::EK_F ek;
+        RH5::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<RH5::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma;
+        RH5::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        for (long n = 0; n < N; n++)
+        {
+            RH5::VK_theta vk_theta;
+            RH5::SK_theta sk;
+            Vec<Fq> theta;
+            Mat<Fq> pi;
+            RH5::MaskGen(vk_theta, sk, theta, env, vk_x[n]);
+            pi.SetDims(env.k, 2);
+            for (int i = 0; i < env.k; i++)
+                RH5::Compute(pi[i], i, ek[i], sigma[n][i], theta[i], env);
+            assert(RH5::Verify(vk_f, vk_x[n], pi, env));
+            RH5::Reconstruct(res, sk, pi, env);
+            assert(res == direct(F, Xs[n]));
+        }
+    }
+    std::cout << "Batched ProbGen OK for all five schemes\n";
+}
+
+void testVerifyBatch() {
+    printHeader("Test batched Verify");
+    // N instances checked at once: a clean batch passes, and after tampering
+    // with instance 1 only ok[1] is false. The 5-variants check at share
+    // point 0, so their tamper hits server 0's row (see testMultiOutput).
+    const long N = 3;
+    auto direct = [](const MultiPoly<Fq> &P, const Vec<Fq> &X) {
+        return P.evaluate(std::vector<Fq>(X.begin(), X.end()));
+    };
+    auto inputs = [](long m) {
+        Vec<Vec<Fq>> Xs;
+        Xs.SetLength(N);
+        for (long n = 0; n < N; n++)
+            Xs[n] = random_vec_ZZ_p(m);
+        return Xs;
+    };
+    auto onlyOneBad = [](const std::vector<bool> &ok) {
+        return ok.size() == N && ok[0] && !ok[1] && ok[2];
+    };
+    Vec<Fq> res;
+    std::vector<bool> ok;
+
+    // SP4 and RH4 fold the k responses through InterpolationMatrix and
+    // bisect a failed product check; two bad instances exercise both halves
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP4::PK_F pk;
+        SP4::VK_F vk_f;
+        SP4::EK_F ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<SP4::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma;
+        Vec<Vec<Fq>> pi;
+        SP4::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        pi.SetLength(N);
+        for (long n = 0; n < N; n++)
+        {
+            pi[n].SetLength(env.k);
+            for (int i = 0; i < env.k; i++)
+                SP4::Compute(pi[n][i], i, ek[i], sigma[n][i], env);
+        }
+        assert(SP4::VerifyBatch(res, ok, vk_f, vk_x, pi, env));
+        for (long n = 0; n < N; n++)
+            assert(ok[n] && res[n] == direct(F, Xs[n]));
+        pi[1][2] += 1;
+        assert(!SP4::VerifyBatch(res, ok, vk_f, vk_x, pi, env) && onlyOneBad(ok));
+        assert(res[0] == direct(F, Xs[0]) && res[2] == direct(F, Xs[2]));
+        pi[1][2] -= 1;
+        pi[0][1] += 1;
+        pi[2][3] += 1;
+        assert(!SP4::VerifyBatch(res, ok, vk_f, vk_x, pi, env) && !ok[0] && ok[1] && !ok[2]);
+        assert(res[1] == direct(F, Xs[1]));
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH4::PK_F pk;
+        RH4::VK_F vk_f;
+        RH4::EK_F ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<RH4::VK_X> vk_x;
+        Vec<RH4::VK_theta> vk_theta;
+        Vec<RH4::SK_theta> sk;
+        Vec<Mat<Fq>> sigma;
+        Vec<Vec<Fq>> pi;
+        RH4::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        pi.SetLength(N);
+        vk_theta.SetLength(N);
+        sk.SetLength(N);
+        for (long n = 0; n < N; n++)
+        {
+            Vec<Fq> theta;
+            RH4::MaskGen(vk_theta[n], sk[n], theta, env, vk_x[n]);
+            pi[n].SetLength(env.k);
+            for (int i = 0; i < env.k; i++)
+                RH4::Compute(pi[n][i], i, ek[i], sigma[n][i], theta[i], env);
+        }
+        assert(RH4::VerifyBatch(ok, vk_f, vk_theta, pi, env));
+        Fq r;
+        for (long n = 0; n < N; n++)
+        {
+            RH4::Reconstruct(r, sk[n], pi[n], env);
+            assert(ok[n] && r == direct(F, Xs[n]));
+        }
+        pi[1][4] += 1;
+        assert(!RH4::VerifyBatch(ok, vk_f, vk_theta, pi, env) && onlyOneBad(ok));
+        pi[1][4] -= 1;
+        pi[0][0] += 1;
+        pi[2][2] += 1;
+        assert(!RH4::VerifyBatch(ok, vk_f, vk_theta, pi, env) && !ok[0] && ok[1] && !ok[2]);
+    }
+    {
+        SP5::Env env;
+        SP5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP5::PK_F pk;
+        SP5::VK_F vk_f;
+        SP5::EK_F ek;
+        SP5::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<SP5::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma, pi;
+        SP5::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        pi.SetLength(N);
+        for (long n = 0; n < N; n++)
+        {
+            pi[n].SetDims(env.k, 2);
+            for (int i = 0; i < env.k; i++)
+                SP5::Compute(pi[n][i], i, ek[i], sigma[n][i], env);
+        }
+        assert(SP5::VerifyBatch(res, ok, vk_f, vk_x, pi, env));
+        for (long n = 0; n < N; n++)
+            assert(ok[n] && res[n] == direct(F, Xs[n]));
+        pi[1][0][0] += 1;
+        assert(!SP5::VerifyBatch(res, ok, vk_f, vk_x, pi, env) && onlyOneBad(ok));
+        assert(res[0] == direct(F, Xs[0]) && res[2] == direct(F, Xs[2]));
+    }
+    {
+        CH5::Env env;
+        CH5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        CH5::PK_F pk;
+        CH5::VK_F vk_f;
+        CH5::EK_F ek;
+        CH5::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<CH5::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma, pi;
+        CH5::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        pi.SetLength(N);
+        for (long n = 0; n < N; n++)
+        {
+            pi[n].SetDims(env.k, 2);
+            for (int i = 0; i < env.k; i++)
+                CH5::Compute(pi[n][i], i, ek[i], sigma[n][i], env);
+        }
+        assert(CH5::VerifyBatch(res, ok, vk_f, vk_x, pi, env));
+        for (long n = 0; n < N; n++)
+            assert(ok[n] && res[n] == direct(F, Xs[n]));
+        pi[1][0][1] += 1;
+        assert(!CH5::VerifyBatch(res, ok, vk_f, vk_x, pi, env) && onlyOneBad(ok));
+        assert(res[0] == direct(F, Xs[0]) && res[2] == direct(F, Xs[2]));
+    }
+    {
+        RH5::Env env;
+        RH5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH5::PK_F pk;
+        RH5::VK_F vk_f;
+        RH5::EK_F ek;
+        RH5::KeyGen(pk, vk_f, ek, env, F);
+        auto Xs = inputs(env.m);
+        Vec<RH5::VK_X> vk_x;
+        Vec<Mat<Fq>> sigma, pi;
+        Vec<RH5::SK_theta> sk;
+        RH5::ProbGenBatch(vk_x, sigma, env, pk, Xs);
+        pi.SetLength(N);
+        sk.SetLength(N);
+        for (long n = 0; n < N; n++)
+        {
+            RH5::VK_theta vk_theta;
+            Vec<Fq> theta;
+            RH5::MaskGen(vk_theta, sk[n], theta, env, vk_x[n]);
+            pi[n].SetDims(env.k, 2);
+            for (int i = 0; i < env.k; i++)
+                RH5::Compute(pi[n][i], i, ek[i], sigma[n][i], theta[i], env);
+        }
+        assert(RH5::VerifyBatch(ok, vk_f, vk_x, pi, env));
+        Fq r;
+        for (long n = 0; n < N; n++)
+        {
+            RH5::Reconstruct(r, sk[n], pi[n], env);
+            assert(ok[n] && r == direct(F, Xs[n]));
+        }
+        pi[1][0][0] += 1;
+        assert(!RH5::VerifyBatch(ok, vk_f, vk_x, pi, env) && onlyOneBad(ok));
+    }
+    std::cout << "Batched Verify OK for all five schemes\n";
+}
+
+void testVerifyPrivate() {
+    printHeader("Test designated-verifier mode");
+    // The client keeps a and alpha in SK_X and checks in the field; a
+    // response changed by one server must be rejected
+    auto direct = [](const MultiPoly<Fq> &P, const Vec<Fq> &X) {
+        return P.evaluate(std::vector<Fq>(X.begin(), X.end()));
+    };
+    Fq res;
+
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP4::PK_F pk;
+        SP4::VK_F vk_f;
+        SP4::EK_F ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m), pi;
+        SP4::SK_X sk_x;
+        Mat<Fq> sigma;
+        SP4::ProbGenPrivate(sk_x, sigma, env, pk, X);
+        pi.SetLength(env.k);
+        for (int i = 0; i < env.k; i++)
+            SP4::Compute(pi[i], i, ek[i], sigma[i], env);
+        assert(SP4::VerifyPrivate(res, vk_f, sk_x, pi, env) && res == direct(F, X));
+        pi[3] += 1;
+        assert(!SP4::VerifyPrivate(res, vk_f, sk_x, pi, env));
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH4::PK_F pk;
+        RH4::VK_F vk_f;
+        RH4::EK_F ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        Vec<Fq> X = random_vec_ZZ_p(env.m), theta, pi;
+        RH4::SK_X sk_x;
+        Mat<Fq> sigma;
+        RH4::ProbGenPrivate(sk_x, sigma, env, pk, X);
+        RH4::DVK_theta dvk;
+        RH4::SK_theta sk;
+        RH4::MaskGenPrivate(dvk, sk, theta, env, sk_x);
+        pi.SetLength(env.k);
+        for (int i = 0; i < env.k; i++)
+            RH4::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+        assert(RH4::VerifyPrivate(vk_f, dvk, pi, env));
+        RH4::Reconstruct(res, sk, pi, env);
+        assert(res == direct(F, X));
+        pi[0] += 1;
+        assert(!RH4::VerifyPrivate(vk_f, dvk, pi, env));
+    }
+    std::cout << "Designated-verifier mode OK\n";
+}
+
+void testOfflineOnline() {
+    printHeader("Test offline/online ProbGen and MaskGen");
+    // ProbGenOffline before X is known, ProbGenOnline once it is, and for
+    // RH4/RH5 MaskGenOffline/MaskGenOnline for the mask; the shares must
+    // verify and give F(X). For SP4 and RH4 this checks the online
+    // weight w_i = 1 - i^(t+1) / alpha^(t+1), which keeps c_j(alpha) = pk_j(a)
+    // while moving c_j(0) to X_j.
+    auto direct = [](const MultiPoly<Fq> &P, const Vec<Fq> &X) {
+        return P.evaluate(std::vector<Fq>(X.begin(), X.end()));
+    };
+    Fq res;
+
+    {
+        SP4::Env env;
+        SP4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP4::PK_F pk;
+        SP4::VK_F vk_f;
+        SP4::EK_F ek;
+        SP4::KeyGen(pk, vk_f, ek, env, F);
+        SP4::PRE_X pre;
+        SP4::ProbGenOffline(pre, env, pk);
+        Vec<Fq> X = random_vec_ZZ_p(env.m), pi;
+        SP4::VK_X vk_x;
+        Mat<Fq> sigma;
+        SP4::ProbGenOnline(vk_x, sigma, env, pre, X);
+        pi.SetLength(env.k);
+        for (int i = 0; i < env.k; i++)
+            SP4::Compute(pi[i], i, ek[i], sigma[i], env);
+        assert(SP4::Verify(res, vk_f, vk_x, pi, env) && res == direct(F, X));
+        pi[2] += 1;
+        assert(!SP4::Verify(res, vk_f, vk_x, pi, env));
+    }
+    {
+        RH4::Env env;
+        RH4::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH4::PK_F pk;
+        RH4::VK_F vk_f;
+        RH4::EK_F ek;
+        RH4::KeyGen(pk, vk_f, ek, env, F);
+        RH4::PRE_X pre;
+        RH4::PRE_theta preMask;
+        RH4::ProbGenOffline(pre, env, pk);
+        RH4::MaskGenOffline(preMask, env);
+        Vec<Fq> X = random_vec_ZZ_p(env.m), theta, pi;
+        RH4::VK_X vk_x;
+        Mat<Fq> sigma;
+        RH4::ProbGenOnline(vk_x, sigma, env, pre, X);
+        RH4::VK_theta vk_theta;
+        RH4::SK_theta sk;
+        RH4::MaskGenOnline(vk_theta, sk, theta, env, preMask, vk_x);
+        pi.SetLength(env.k);
+        for (int i = 0; i < env.k; i++)
+            RH4::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+        assert(RH4::Verify(vk_f, vk_theta, pi, env));
+        RH4::Reconstruct(res, sk, pi, env);
+        assert(res == direct(F, X));
+        pi[2] += 1;
+        assert(!RH4::Verify(vk_f, vk_theta, pi, env));
+    }
+    {
+        SP5::Env env;
+        SP5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        SP5::PK_F pk;
+        SP5::VK_F vk_f;
+        SP5::EK_F ek;
+        SP5::KeyGen(pk, vk_f, ek, env, F);
+        SP5::PRE_X pre;
+        SP5::ProbGenOffline(pre, env, pk);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        SP5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        SP5::ProbGenOnline(vk_x, sigma, env, pre, X);
+        pi.SetDims(env.k, 2);
+        for (int i = 0; i < env.k; i++)
+            SP5::Compute(pi[i], i, ek[i], sigma[i], env);
+        assert(SP5::Verify(res, vk_f, vk_x, pi, env) && res == direct(F, X));
+    }
+    {
+        CH5::Env env;
+        CH5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        CH5::PK_F pk;
+        CH5::VK_F vk_f;
+        CH5::EK_F ek;
+        CH5::KeyGen(pk, vk_f, ek, env, F);
+        CH5::PRE_X pre;
+        CH5::ProbGenOffline(pre, env, pk);
+        Vec<Fq> X = random_vec_ZZ_p(env.m);
+        CH5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        CH5::ProbGenOnline(vk_x, sigma, env, pre, X);
+        pi.SetDims(env.k, 2);
+        for (int i = 0; i < env.k; i++)
+            CH5::Compute(pi[i], i, ek[i], sigma[i], env);
+        assert(CH5::Verify(res, vk_f, vk_x, pi, env) && res == direct(F, X));
+    }
+    {
+        RH5::Env env;
+        RH5::Initialize(env, 1, 128);
+        auto F = generateFullPoly<Fq>(4, 2, to_ZZ_p(3));
+        RH5::PK_F pk;
+        RH5::VK_F vk_f;
+        RH5::EK_F ek;
+        RH5::KeyGen(pk, vk_f, ek, env, F);
+        RH5::PRE_X pre;
+        RH5::PRE_theta preMask;
+        RH5::ProbGenOffline(pre, env, pk);
+        RH5::MaskGenOffline(preMask, env);
+        Vec<Fq> X = random_vec_ZZ_p(env.m), theta;
+        RH5::VK_X vk_x;
+        Mat<Fq> sigma, pi;
+        RH5::ProbGenOnline(vk_x, sigma, env, pre, X);
+        RH5::VK_theta vk_theta;
+        RH5::SK_theta sk;
+        RH5::MaskGenOnline(vk_theta, sk, theta, env, preMask, vk_x);
+        pi.SetDims(env.k, 2);
+        for (int i = 0; i < env.k; i++)
+            RH5::Compute(pi[i], i, ek[i], sigma[i], theta[i], env);
+        assert(RH5::Verify(vk_f, vk_x, pi, env));
+        RH5::Reconstruct(res, sk, pi, env);
+        assert(res == direct(F, X));
+    }
+    std::cout << "Offline/online ProbGen and MaskGen OK for all five schemes\n";
+}
+
 int main() {
     testGenerateFullPoly();
     testAddition();
@@ -106,6 +1962,33 @@ int main() {
     testEvaluate();
     testPolyPow();
     testCompose();
+    testEvalKey();
+    testPreparedPoly();
+    testSerialization();
+    testStreamedPoly();
+    testBatchHelpers();
+    testMultiExp();
+    testPrecomputePool();
+    testPackedAffine();
+    testStragglerSim();
+    testIncrementalEvaluator();
+    testDecodeRS();
+    testQuadraticPoly();
+    testLinearForms();
+    testCircuit();
+    testKronecker();
+    testMonomialEnumerator();
+    testWorkload();
+    testPolyLoader();
+    testPackedRH5();
+    testRH5Session();
+    testUpdateKey();
+    testVerifyRobust();
+    testMultiOutput();
+    testProbGenBatch();
+    testVerifyBatch();
+    testVerifyPrivate();
+    testOfflineOnline();
     std::cout << "\nAll tests passed!\n";
     return 0;
 }
\ No newline at end of file
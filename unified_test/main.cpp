@@ -17,6 +17,10 @@ struct TestConfig
     int m;      // number of variables
     int t;      // privacy parameter
     int secpar; // security parameter
+    int ell;    // slots per round for packed variants
+    int spare;  // servers beyond k for first-k variants
+    std::string latency; // per-server latency models for first-k variants
+    std::string workload; // F and X for the unpacked variants, see Workload.h
     int iterations;
 };
 
@@ -46,23 +50,31 @@ TestResult runTest(const std::string &testName, const TestConfig &config)
         // Note: Some tests use different parameter orders (t,m,d vs d,m,t)
         if (testName == "MSVC_RH_4")
         {
-            result = RH_4_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations);
+            result = RH_4_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations, config.workload);
         }
         else if (testName == "MSVC_SP_4")
         {
-            result = SP_4_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations);
+            result = SP_4_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations, config.workload);
         }
         else if (testName == "MSVC_RH_5")
         {
-            result = RH_5_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations);
+            result = RH_5_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations, config.workload);
+        }
+        else if (testName == "MSVC_RH_5_PACKED")
+        {
+            result = RH_5_PACKED_TIMETEST(config.d, config.m, config.t, config.ell, config.secpar, config.iterations);
+        }
+        else if (testName == "MSVC_RH_5_FIRSTK")
+        {
+            result = RH_5_FIRSTK_TIMETEST(config.d, config.m, config.t, config.spare, config.latency, config.secpar, config.iterations);
         }
         else if (testName == "MSVC_SP_5")
         {
-            result = SP_5_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations);
+            result = SP_5_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations, config.workload);
         }
         else if (testName == "MSVC_CH_5")
         {
-            result = CH_5_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations);
+            result = CH_5_TIMETEST(config.d, config.m, config.t, config.secpar, config.iterations, config.workload);
         }
     }
     catch (const std::exception &e)
@@ -104,7 +116,7 @@ void printComparisonResults(const std::vector<TestResult> &results)
     std::cout << std::string(96, '-') << std::endl;
 
     // Define the custom order for display
-    std::vector<std::string> displayOrder = {"SP_4", "RH_4", "SP_5", "CH_5", "RH_5"};
+    std::vector<std::string> displayOrder = {"SP_4", "RH_4", "SP_5", "CH_5", "RH_5", "RH_5_PACKED", "RH_5_FIRSTK"};
 
     // Find and print algorithms in the specified order
     bool dividerPrinted = false;
@@ -122,7 +134,7 @@ void printComparisonResults(const std::vector<TestResult> &results)
         auto it = std::find_if(results.begin(), results.end(),
                                [&algoName](const TestResult &result)
                                {
-                                   return result.algorithm_name.find(algoName) != std::string::npos;
+                                   return result.algorithm_name == "MSVC_" + algoName;
                                });
 
         if (it != results.end())
@@ -146,6 +158,8 @@ void printComparisonResults(const std::vector<TestResult> &results)
     // Add a note about maskGen and Reconstruct
     std::cout << "\nNote: MaskGen and Reconstruct columns only apply to RH4 and RH5 algorithms." << std::endl;
     std::cout << "      SP4, SP5, and CH5 algorithms do not include these steps." << std::endl;
+    std::cout << "      RH_5_PACKED times are per input (one round divided by ell)." << std::endl;
+    std::cout << "      RH_5_FIRSTK Compute is the simulated wait for the first k of k+spare responses." << std::endl;
 }
 
 // Print usage instructions
@@ -158,6 +172,14 @@ void printUsage(const char *programName)
     std::cout << "  -t <value>       Set privacy parameter (default: 1)" << std::endl;
     std::cout << "  -secpar <value>  Set security parameter (default: 128)" << std::endl;
     std::cout << "  -iter <value>    Set number of iterations (default: 10)" << std::endl;
+    std::cout << "  -ell <value>     Set slots per round for RH5P (default: 4)" << std::endl;
+    std::cout << "  -spare <value>   Set servers beyond k for RH5K (default: 2)" << std::endl;
+    std::cout << "  -latency <spec>  Set server latency for RH5K (default: exp:0:5)" << std::endl;
+    std::cout << "                   const:B, exp:B:MEAN, lognormal:B:MEDIAN:SIGMA or" << std::endl;
+    std::cout << "                   pareto:B:XM:ALPHA in ms; a comma list cycles over servers" << std::endl;
+    std::cout << "  -workload <spec> Set F and X for SP4, RH4, SP5, CH5, RH5 (default: full)" << std::endl;
+    std::cout << "                   full, or sparse:TERMS[:DENSITY[:DEGREE[:COEFF[:SEED]]]] with" << std::endl;
+    std::cout << "                   DEGREE uniform|top|geom and COEFF random|small|one" << std::endl;
     std::cout << "  -all             Run all tests" << std::endl;
     std::cout << "  -h, --help       Show this help message" << std::endl;
     std::cout << std::endl;
@@ -165,6 +187,8 @@ void printUsage(const char *programName)
     std::cout << "  CH5              Run MSVC_CH_5 timetest" << std::endl;
     std::cout << "  RH4              Run MSVC_RH_4 timetest" << std::endl;
     std::cout << "  RH5              Run MSVC_RH_5 timetest" << std::endl;
+    std::cout << "  RH5P             Run packed MSVC_RH_5 timetest" << std::endl;
+    std::cout << "  RH5K             Run MSVC_RH_5 first-k straggler timetest" << std::endl;
     std::cout << "  SP4              Run MSVC_SP_4 timetest" << std::endl;
     std::cout << "  SP5              Run MSVC_SP_5 timetest" << std::endl;
 }
@@ -177,6 +201,10 @@ int main(int argc, char *argv[])
         .m = 100,        // number of variables
         .t = 1,          // privacy parameter
         .secpar = 128,   // security parameter
+        .ell = 4,        // slots per round
+        .spare = 2,      // servers beyond k
+        .latency = "exp:0:5", // server latency model
+        .workload = "full", // polynomial workload
         .iterations = 10 // iterations
     };
 
@@ -185,6 +213,8 @@ int main(int argc, char *argv[])
         {"CH5", "MSVC_CH_5"},
         {"RH4", "MSVC_RH_4"},
         {"RH5", "MSVC_RH_5"},
+        {"RH5P", "MSVC_RH_5_PACKED"},
+        {"RH5K", "MSVC_RH_5_FIRSTK"},
         {"SP4", "MSVC_SP_4"},
         {"SP5", "MSVC_SP_5"}};
 
@@ -218,6 +248,22 @@ int main(int argc, char *argv[])
         {
             config.secpar = std::stoi(argv[++i]);
         }
+        else if (arg == "-ell" && i + 1 < argc)
+        {
+            config.ell = std::stoi(argv[++i]);
+        }
+        else if (arg == "-spare" && i + 1 < argc)
+        {
+            config.spare = std::stoi(argv[++i]);
+        }
+        else if (arg == "-latency" && i + 1 < argc)
+        {
+            config.latency = argv[++i];
+        }
+        else if (arg == "-workload" && i + 1 < argc)
+        {
+            config.workload = argv[++i];
+        }
         else if (arg == "-iter" && i + 1 < argc)
         {
             config.iterations = std::stoi(argv[++i]);
@@ -255,6 +301,10 @@ int main(int argc, char *argv[])
     std::cout << "  - Number of variables (m): " << config.m << std::endl;
     std::cout << "  - Privacy parameter (t): " << config.t << std::endl;
     std::cout << "  - Security parameter (secpar): " << config.secpar << std::endl;
+    std::cout << "  - Slots per round (ell): " << config.ell << std::endl;
+    std::cout << "  - Spare servers: " << config.spare << std::endl;
+    std::cout << "  - Server latency: " << config.latency << std::endl;
+    std::cout << "  - Workload: " << config.workload << std::endl;
     std::cout << "  - Iterations: " << config.iterations << std::endl;
 
     auto startTime = std::chrono::high_resolution_clock::now();
@@ -24,21 +24,28 @@ struct TestResult {
     int total_runs;
 };
 
-// Forward declarations for timetest functions
+// Forward declarations for timetest functions. workload is a WorkloadSpec
+// string (see Workload.h); the packed and first-k variants always use "full".
 
-    TestResult CH_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent = true);
+    TestResult CH_5_TIMETEST(int d, int m, int t, int secpar, int iterations, const std::string &workload = "full", bool silent = true);
 
 
 
-    TestResult RH_4_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent = true);
+    TestResult RH_4_TIMETEST(int d, int m, int t, int secpar, int iterations, const std::string &workload = "full", bool silent = true);
 
 
 
-    TestResult RH_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent = true);
+    TestResult RH_5_TIMETEST(int d, int m, int t, int secpar, int iterations, const std::string &workload = "full", bool silent = true);
 
+    // Packed RH5 with ell inputs per round; times are per input
+    TestResult RH_5_PACKED_TIMETEST(int d, int m, int t, int ell, int secpar, int iterations, bool silent = true);
 
-    TestResult SP_4_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent = true);
+    // RH5 on k + spare servers, waiting for the first k responses
+    TestResult RH_5_FIRSTK_TIMETEST(int d, int m, int t, int spare, const std::string &latency, int secpar, int iterations, bool silent = true);
 
 
+    TestResult SP_4_TIMETEST(int d, int m, int t, int secpar, int iterations, const std::string &workload = "full", bool silent = true);
 
-    TestResult SP_5_TIMETEST(int d, int m, int t, int secpar, int iterations, bool silent = true);
+
+
+    TestResult SP_5_TIMETEST(int d, int m, int t, int secpar, int iterations, const std::string &workload = "full", bool silent = true);